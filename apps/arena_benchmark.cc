@@ -0,0 +1,160 @@
+#include "buffer.hh"
+#include "buffer_storage.hh"
+#include "byte_stream.hh"
+#include "huge_page_arena.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t connections = 4096;  // each with a send and a receive ByteStream
+static constexpr size_t capacity = 64 * 1024;
+static constexpr size_t backlog = 48 * 1024;
+static constexpr size_t segment = 1452;
+static constexpr size_t reps = 5'000'000;
+
+//! Counts the calling thread's data-TLB read misses, in user space, if the CPU and kernel let us
+class DTLBMissCounter {
+    int _fd{-1};
+
+  public:
+    DTLBMissCounter() {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    DTLBMissCounter(const DTLBMissCounter &other) = delete;
+    DTLBMissCounter &operator=(const DTLBMissCounter &other) = delete;
+    ~DTLBMissCounter() {
+        if (_fd >= 0) {
+            close(_fd);
+        }
+    }
+
+    bool available() const { return _fd >= 0; }
+    void start() const {
+        ioctl_or_ignore(PERF_EVENT_IOC_RESET);
+        ioctl_or_ignore(PERF_EVENT_IOC_ENABLE);
+    }
+    uint64_t stop() const {
+        ioctl_or_ignore(PERF_EVENT_IOC_DISABLE);
+        uint64_t count = 0;
+        if (_fd < 0 || read(_fd, &count, sizeof(count)) != sizeof(count)) {
+            return 0;
+        }
+        return count;
+    }
+
+  private:
+    void ioctl_or_ignore(const unsigned long request) const {
+        if (_fd >= 0) {
+            SystemCall("ioctl", ioctl(_fd, request, 0));
+        }
+    }
+};
+
+//! Bytes of this process's anonymous memory that the kernel has backed with transparent huge pages
+static size_t anon_huge_bytes() {
+    ifstream smaps{"/proc/self/smaps_rollup"};
+    string key;
+    size_t kb = 0;
+    while (smaps >> key) {
+        if (key == "AnonHugePages:" && smaps >> kb) {
+            return kb * 1024;
+        }
+        smaps.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    return 0;
+}
+
+//! Give every connection a send and a receive ByteStream (whose bytes are in blocks from the BufferPool),
+//! each holding a backlog of `backlog` bytes, then pass `reps` segments through the streams of randomly
+//! chosen connections, printing the time and dTLB misses per segment
+static void churn(const string &what) {
+    const DTLBMissCounter counter;
+    const size_t huge_before = anon_huge_bytes();
+    vector<ByteStream> streams;
+    streams.reserve(2 * connections);
+    for (size_t i = 0; i < 2 * connections; i++) {
+        streams.emplace_back(capacity);
+        streams.back().write(string(backlog, static_cast<char>(i)));
+    }
+
+    auto rd = get_random_generator();
+    vector<uint32_t> picks(1 << 16);
+    for (auto &pick : picks) {
+        pick = static_cast<uint32_t>(rd());
+    }
+
+    const string payload(segment, 'p');
+    size_t sink = 0;
+    counter.start();
+    const auto start = steady_clock::now();
+    for (size_t i = 0; i < reps; i++) {
+        const size_t conn = (picks[i % picks.size()] ^ static_cast<uint32_t>(i)) % connections;
+        ByteStream &send = streams[2 * conn];
+        ByteStream &recv = streams[2 * conn + 1];
+        send.write(payload);
+        uint16_t sum = 0;
+        recv.write(send.read(segment, sum));
+        recv.pop_output(segment);
+        sink += sum;
+    }
+    const auto duration = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    const uint64_t misses = counter.stop();
+
+    cout << "   " << left << setw(26) << what << right << fixed << setprecision(1)
+         << static_cast<double>(duration) / reps << " ns and ";
+    if (counter.available()) {
+        cout << setprecision(3) << static_cast<double>(misses) / reps << " dTLB misses";
+    } else {
+        cout << "(no dTLB counter)";
+    }
+    cout << " per segment, " << (anon_huge_bytes() - huge_before) / (1024 * 1024) << " MiB in huge pages"
+         << (sink == 0 ? " (?)" : "") << "\n";
+}
+
+int main() {
+    try {
+        cout << "Passing " << segment << "-byte segments through the ByteStreams of " << connections
+             << " connections:\n";
+
+        // each run is on its own thread, so that it starts with empty free lists and allocates its own slabs
+        thread{[] { churn("blocks from the heap"); }}.join();
+
+        static HugePageArena arena{};
+        BufferPool::set_arena(&arena);
+        thread{[] { churn("blocks from HugePageArena"); }}.join();
+
+        const auto stats = arena.stats();
+        cout << "Arena: " << stats.chunks << " chunks (" << stats.hugetlb << " MAP_HUGETLB, " << stats.transparent
+             << " transparent), " << stats.mapped / (1024 * 1024) << " MiB mapped\n";
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+#include "buffer.hh"
+#include "buffer_storage.hh"
+#include "tcp_segment.hh"
+#include "tcp_sender.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t reps = 10'000'000;
+static constexpr size_t window = 64;  // buffers outstanding at a time, as in a send queue
+
+//! Create `reps` buffers of `size` bytes with `make`, keeping the last `window` alive, and print the cost of each
+template <typename T, typename F>
+static void churn(const string &what, const size_t size, F &&make) {
+    array<T, window> ring{};
+    const auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < reps; i++) {
+        ring[i % window] = make(size);
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(30) << what << right << setw(6) << size << " B: " << fixed << setprecision(1)
+         << static_cast<double>(duration) / reps << " ns per allocation and free\n";
+}
+
+//! Push `total` bytes through a TCPSender, copying each segment as a connection would on its way to
+//! writev(2), and print the throughput
+static void send_all(const string &what, const size_t total) {
+    TCPSender sender{TCPConfig::DEFAULT_CAPACITY, TCPConfig::TIMEOUT_DFLT, WrappingInt32{0}};
+    const string chunk(TCPConfig::DEFAULT_CAPACITY / 4, 'x');
+    queue<TCPSegment> wire{};
+    size_t pieces = 0;
+
+    sender.fill_window();
+    sender.ack_received(WrappingInt32{1}, 0xffff);
+    const auto start = high_resolution_clock::now();
+    for (size_t sent = 0; sent < total;) {
+        sent += sender.stream_in().write(chunk);
+        sender.fill_window();
+        while (not sender.segments_out().empty()) {
+            wire.push(sender.segments_out().front());
+            sender.segments_out().pop();
+        }
+        while (not wire.empty()) {
+            const BufferList frame = wire.front().serialize();
+            pieces += BufferViewList{frame}.iovec_count();
+            wire.pop();
+        }
+        sender.ack_received(sender.next_seqno(), 0xffff);
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(30) << what << right << fixed << setprecision(2)
+         << static_cast<double>(total) / static_cast<double>(duration) << " GB/s" << (pieces == 0 ? " (?)" : "")
+         << "\n";
+}
+
+int main() {
+    try {
+        for (const size_t size : {64, 1452}) {
+            churn<shared_ptr<string>>("make_shared<string> (before)", size, [](const size_t n) {
+                auto ret = make_shared<string>(n, '\0');
+                ret->front() = 'x';
+                return ret;
+            });
+            churn<Buffer>("Buffer(string &&)", size, [](const size_t n) {
+                string s(n, '\0');
+                s.front() = 'x';
+                return Buffer{move(s)};
+            });
+            churn<Buffer>("Buffer(BufferPool::allocate)", size, [](const size_t n) {
+                BufferStorage::Ptr block = BufferPool::allocate(n);
+                block->data()[0] = 'x';
+                return Buffer{move(block)};
+            });
+        }
+
+        cout << "Sending segments through a TCPSender:\n";
+        send_all("atomic reference counts", 4'000'000'000);
+        BufferStorage::confine_to_this_thread();
+        send_all("confined to this thread", 4'000'000'000);
+        BufferStorage::confine_to_this_thread(false);
+
+        const auto &stats = BufferPool::stats();
+        cout << "Pool: " << stats.hits << " hits, " << stats.misses << " misses, high-water mark " << stats.high_water
+             << " blocks, " << stats.slabs << " slabs\n";
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include "checksum.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t total_bytes = size_t{1} << 30;
+
+//! Checksum buffers of `size` bytes, `total_bytes` in all, and print the throughput
+template <typename F>
+static void throughput(const string &what, const size_t size, const string &buf, F &&f) {
+    const size_t reps = total_bytes / size;
+    uint64_t sink = 0;
+    const auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < reps; i++) {
+        sink += f(string_view{buf}.substr((i * 64) % (buf.size() - size), size));
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(16) << what << right << setw(7) << size << " B: " << fixed << setprecision(2)
+         << setw(7) << static_cast<double>(reps * size) / static_cast<double>(duration) << " GB/s"
+         << (sink == 0 ? " (?)" : "") << "\n";
+}
+
+//! Copy and checksum `total_bytes` in buffers of `size` bytes, walking through all of `src` (larger than the
+//! caches) so that the source bytes come from memory, and print the throughput
+template <typename F>
+static void copy_throughput(const string &what, const size_t size, const string &src, F &&f) {
+    const size_t reps = total_bytes / size;
+    string dst(size, 0);
+    uint64_t sink = 0;
+    const auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < reps; i++) {
+        const auto *from = reinterpret_cast<const uint8_t *>(src.data()) + (i * size) % (src.size() - size);
+        sink += f(reinterpret_cast<uint8_t *>(dst.data()), from, size);
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(16) << what << right << setw(7) << size << " B: " << fixed << setprecision(2)
+         << setw(7) << static_cast<double>(reps * size) / static_cast<double>(duration) << " GB/s"
+         << (sink == 0 ? " (?)" : "") << "\n";
+}
+
+int main() {
+    try {
+        mt19937 rng{0};
+        string buf(1 << 20, 0);
+        for (auto &c : buf) {
+            c = static_cast<char>(rng());
+        }
+
+        using Variant = ChecksumKernel::Variant;
+        cout << "ChecksumKernel (InternetChecksum uses " << ChecksumKernel::name(ChecksumKernel::best()) << "):\n";
+        for (const size_t size : {64, 1500, 65536}) {
+            for (const Variant variant : {Variant::Bytewise, Variant::Word, Variant::SSE2, Variant::AVX2}) {
+                if (ChecksumKernel::supported(variant)) {
+                    throughput(ChecksumKernel::name(variant), size, buf, [variant](const string_view data) {
+                        const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+                        return ChecksumKernel::sum(variant, bytes, data.size());
+                    });
+                }
+            }
+            throughput("InternetChecksum", size, buf, [](const string_view data) {
+                InternetChecksum check;
+                check.add(data);
+                return check.value();
+            });
+        }
+
+        string big(size_t{256} << 20, 0);
+        for (size_t i = 0; i < big.size(); i += 4096) {
+            big[i] = static_cast<char>(rng());
+        }
+        cout << "Copying and checksumming a payload (source not in cache):\n";
+        for (const size_t size : {64, 1500, 65536}) {
+            copy_throughput("memcpy, then sum", size, big, [](uint8_t *dst, const uint8_t *src, const size_t len) {
+                memcpy(dst, src, len);
+                return ChecksumKernel::sum(dst, len);
+            });
+            copy_throughput("sum, then memcpy", size, big, [](uint8_t *dst, const uint8_t *src, const size_t len) {
+                const uint16_t sum = ChecksumKernel::sum(src, len);
+                memcpy(dst, src, len);
+                return sum;
+            });
+            copy_throughput("copy_and_sum", size, big, [](uint8_t *dst, const uint8_t *src, const size_t len) {
+                return ChecksumKernel::copy_and_sum(dst, src, len);
+            });
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
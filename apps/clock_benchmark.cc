@@ -0,0 +1,58 @@
+#include "clock.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t n_calls = 10'000'000;
+
+//! Time `n_calls` calls of `f`, and print the cost per call
+template <typename F>
+static void cost(const string &what, F &&f) {
+    uint64_t sum = 0;
+    const auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < n_calls; i++) {
+        sum += f();
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(44) << what << right << fixed << setprecision(2) << setw(8)
+         << static_cast<double>(duration) / n_calls << " ns per call" << (sum == 0 ? " (?)" : "") << "\n";
+}
+
+int main() {
+    try {
+        cout << "Resolution:\n";
+        cout << "   CLOCK_MONOTONIC_COARSE: " << Clock::coarse_resolution_ns() << " ns\n";
+        if (TSC::available()) {
+            cout << "   TSC: " << setprecision(4) << TSC::ns_per_tick() << " ns per tick\n";
+        } else {
+            cout << "   TSC: not available (TSC::ns() reads CLOCK_MONOTONIC)\n";
+        }
+
+        cout << "Cost:\n";
+        cost("std::chrono::steady_clock::now()", [] { return steady_clock::now().time_since_epoch().count(); });
+        cost("Clock::monotonic_ns()", [] { return Clock::monotonic_ns(); });
+        cost("Clock::coarse_ns()", [] { return Clock::coarse_ns(); });
+        cost("TSC::ns()", [] { return TSC::ns(); });
+        cost("TSC::ticks()", [] { return TSC::ticks(); });
+        cost("timestamp_ms(), outside an iteration", [] { return timestamp_ms() + 1; });
+        {
+            const Clock::Iteration iteration{};
+            cost("Clock::now_ns(), within an iteration", [] { return Clock::now_ns(); });
+            cost("timestamp_ms(), within an iteration", [] { return timestamp_ms() + 1; });
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
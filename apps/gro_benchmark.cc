@@ -0,0 +1,92 @@
+#include "tcp_config.hh"
+#include "tcp_gro.hh"
+#include "tcp_receiver.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t len = 64 * 1024 * 1024;
+static constexpr size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+//! Build `len` bytes of in-order data segments following a SYN with sequence number `isn`
+static vector<TCPSegment> make_segments(const WrappingInt32 isn) {
+    vector<TCPSegment> segments;
+    segments.reserve(len / mss + 1);
+    for (size_t offset = 0; offset < len; offset += mss) {
+        TCPSegment seg;
+        seg.header().ack = true;
+        seg.header().seqno = isn + 1 + offset;
+        seg.payload() = string(min(mss, len - offset), 'x');
+        segments.push_back(move(seg));
+    }
+    return segments;
+}
+
+//! Deliver the segments to a TCPReceiver in batches of `batch_size`, with or without coalescing
+static void receive(const vector<TCPSegment> &segments, const size_t batch_size, const bool coalesce) {
+    TCPConfig cfg;
+    cfg.recv_capacity = 4 * 1024 * 1024;
+    TCPReceiver receiver{cfg};
+    TCPSegmentCoalescer gro;
+
+    TCPSegment syn;
+    syn.header().syn = true;
+    syn.header().seqno = segments.front().header().seqno - 1;
+    receiver.segment_received(syn);
+
+    vector<TCPSegment> batch;
+    batch.reserve(batch_size);
+
+    const auto first_time = high_resolution_clock::now();
+
+    for (size_t i = 0; i < segments.size(); i += batch_size) {
+        batch.assign(segments.begin() + i, segments.begin() + min(segments.size(), i + batch_size));
+        if (coalesce) {
+            for (const auto &run : gro.coalesce(batch)) {
+                receiver.segment_received(run);
+            }
+        } else {
+            for (const auto &seg : batch) {
+                receiver.segment_received(seg);
+            }
+        }
+        receiver.stream_out().pop_output(receiver.stream_out().buffer_size());
+    }
+
+    const auto final_time = high_resolution_clock::now();
+
+    if (receiver.stream_out().bytes_written() != len) {
+        throw runtime_error("receiver did not reassemble every byte");
+    }
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+    cout << "   batch " << setw(3) << batch_size << (coalesce ? ", coalesced:   " : ", one by one:  ") << fixed
+         << setprecision(3) << static_cast<double>(duration) / len << " ns/byte";
+    if (coalesce) {
+        cout << " (" << setprecision(1) << static_cast<double>(gro.stats().segments) / gro.stats().runs
+             << " segments per run)";
+    }
+    cout << "\n";
+}
+
+int main() {
+    try {
+        const auto segments = make_segments(WrappingInt32{0x12345678});
+        for (const size_t batch_size : {1, 8, 16, 32, 64}) {
+            receive(segments, batch_size, false);
+            receive(segments, batch_size, true);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
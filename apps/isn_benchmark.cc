@@ -0,0 +1,71 @@
+#include "tcp_config.hh"
+#include "tcp_isn.hh"
+#include "tcp_receiver.hh"
+#include "tcp_sender.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t n_conns = 200000;
+
+//! Time `n` calls of `f`, and print the rate
+template <typename F>
+static void rate(const string &what, const size_t n, F &&f) {
+    const auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        f();
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(52) << what << right << fixed << setprecision(0) << setw(12)
+         << n / (static_cast<double>(duration) / 1e9) << " per second\n";
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.send_capacity = 1024;
+        cfg.recv_capacity = 1024;
+        const Address local{"10.0.0.1", 40000};
+        const Address remote{"10.0.0.2", 80};
+
+        cout << "ISNs:\n";
+        rate("std::random_device", n_conns, [] { WrappingInt32{random_device()()}; });
+        rate("ISNGenerator::isn()", n_conns, [] { ISNGenerator::isn(); });
+        rate("ISNGenerator::isn(local, remote)", n_conns, [&] { ISNGenerator::isn(local, remote); });
+
+        cout << "Connections (a TCPSender and a TCPReceiver):\n";
+        rate("ISN from std::random_device (before)", n_conns, [&] {
+            TCPConfig c = cfg;
+            c.fixed_isn = WrappingInt32{random_device()()};
+            TCPSender sender{c};
+            TCPReceiver receiver{c};
+        });
+        rate("ISN from ISNGenerator (after)", n_conns, [&] {
+            TCPSender sender{cfg};
+            TCPReceiver receiver{cfg};
+        });
+        rate("ISN for the 4-tuple from ISNGenerator", n_conns, [&] {
+            TCPConfig c = cfg;
+            c.fixed_isn = ISNGenerator::isn(local, remote);
+            TCPSender sender{c};
+            TCPReceiver receiver{c};
+        });
+
+        cout << "Seeding a generator:\n";
+        rate("get_random_generator()", n_conns / 100, [] { get_random_generator(); });
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
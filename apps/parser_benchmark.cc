@@ -0,0 +1,188 @@
+#include "buffer.hh"
+#include "parser.hh"
+#include "tcp_header.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t rounds = 200;
+
+//! NetParser as it was first written: every byte through Buffer::at(), every field through remove_prefix()
+class ReferenceParser {
+    Buffer _buffer;
+    bool _error{false};
+
+    template <typename T>
+    T parse_int() {
+        if (sizeof(T) > _buffer.size()) {
+            _error = true;
+            return 0;
+        }
+        T ret = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            ret <<= 8;
+            ret += uint8_t(_buffer.at(i));
+        }
+        _buffer.remove_prefix(sizeof(T));
+        return ret;
+    }
+
+  public:
+    explicit ReferenceParser(Buffer buffer) : _buffer(move(buffer)) {}
+
+    const Buffer &buffer() const { return _buffer; }
+    bool error() const { return _error; }
+    uint32_t u32() { return parse_int<uint32_t>(); }
+    uint16_t u16() { return parse_int<uint16_t>(); }
+    uint8_t u8() { return parse_int<uint8_t>(); }
+};
+
+//! TCPHeader::parse() as it was first written (the options are decoded the same way in both)
+static ParseResult reference_parse(TCPHeader &hdr, const Buffer &buffer) {
+    ReferenceParser p{buffer};
+    hdr.sport = p.u16();
+    hdr.dport = p.u16();
+    hdr.seqno = WrappingInt32{p.u32()};
+    hdr.ackno = WrappingInt32{p.u32()};
+    hdr.doff = p.u8() >> 4;
+    const uint8_t fl_b = p.u8();
+    hdr.cwr = fl_b & 0b1000'0000;
+    hdr.ece = fl_b & 0b0100'0000;
+    hdr.urg = fl_b & 0b0010'0000;
+    hdr.ack = fl_b & 0b0001'0000;
+    hdr.psh = fl_b & 0b0000'1000;
+    hdr.rst = fl_b & 0b0000'0100;
+    hdr.syn = fl_b & 0b0000'0010;
+    hdr.fin = fl_b & 0b0000'0001;
+    hdr.win = p.u16();
+    hdr.cksum = p.u16();
+    hdr.uptr = p.u16();
+    if (hdr.doff < 5) {
+        return ParseResult::HeaderTooShort;
+    }
+    if (p.error()) {
+        return ParseResult::PacketTooShort;
+    }
+    NetParser rest{p.buffer()};
+    return hdr.options.parse(rest, hdr.doff * 4 - TCPHeader::LENGTH);
+}
+
+//! The TCP segments in a classic (libpcap-format) capture of Ethernet frames, or none if it cannot be read
+static vector<Buffer> read_pcap(const string &filename) {
+    ifstream file{filename, ios::binary};
+    const string data{istreambuf_iterator<char>{file}, istreambuf_iterator<char>{}};
+    const auto *raw = reinterpret_cast<const uint8_t *>(data.data());
+
+    vector<Buffer> segments;
+    if (data.size() < 24) {
+        return segments;
+    }
+    const bool swapped = NetParser::load_u32(raw) == 0xd4c3b2a1;  // the file's byte order is little-endian
+    const auto u32 = [&](const size_t at) {
+        const uint32_t val = NetParser::load_u32(raw + at);
+        return swapped ? __builtin_bswap32(val) : val;
+    };
+    if (u32(0) != 0xa1b2c3d4 || u32(20) != 1) {
+        return segments;
+    }
+
+    for (size_t at = 24; at + 16 <= data.size();) {
+        const size_t caplen = u32(at + 8);
+        const size_t frame = at + 16;
+        at = frame + caplen;
+        if (at > data.size() || caplen < 14 + 20 || NetParser::load_u16(raw + frame + 12) != 0x0800) {
+            continue;
+        }
+        const size_t ip = frame + 14;
+        const size_t ihl = 4 * (raw[ip] & 0x0f);
+        const size_t total = NetParser::load_u16(raw + ip + 2);
+        if (raw[ip + 9] != 6 || ihl < 20 || total < ihl + 20 || ip + total > at) {
+            continue;
+        }
+        segments.emplace_back(data.substr(ip + ihl, total - ihl));
+    }
+    return segments;
+}
+
+//! Headers like those of a bulk transfer: mostly ACKs with timestamps, some with SACK blocks, a few SYNs
+static vector<Buffer> synthetic_segments(const size_t n) {
+    mt19937 rng{0};
+    vector<Buffer> segments;
+    for (size_t i = 0; i < n; i++) {
+        TCPHeader hdr;
+        hdr.sport = rng();
+        hdr.dport = 443;
+        hdr.seqno = WrappingInt32{static_cast<uint32_t>(rng())};
+        hdr.ackno = WrappingInt32{static_cast<uint32_t>(rng())};
+        hdr.ack = true;
+        hdr.win = rng();
+        if (i % 4 != 0) {
+            hdr.options.ts = TCPOptions::Timestamps{static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng())};
+        }
+        if (i % 10 == 1) {
+            hdr.options.num_sack_blocks = 2;
+        }
+        if (i % 100 == 0) {
+            hdr.syn = true;
+            hdr.options.mss = 1460;
+            hdr.options.wscale = 7;
+            hdr.options.sack_permitted = true;
+        }
+        segments.emplace_back(hdr.serialize() + string(rng() % 1460, 'x'));
+    }
+    return segments;
+}
+
+//! Parse every header `rounds` times and print the time per header
+template <typename F>
+static void parse_all(const string &what, const vector<Buffer> &segments, F &&parse) {
+    TCPHeader hdr;
+    size_t ok = 0;
+    const auto start = high_resolution_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const auto &seg : segments) {
+            ok += parse(hdr, seg) == ParseResult::NoError;
+        }
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(28) << what << right << fixed << setprecision(1)
+         << static_cast<double>(duration) / (rounds * segments.size()) << " ns per header (" << ok / rounds
+         << " of " << segments.size() << " parsed)\n";
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        vector<Buffer> segments;
+        if (argc > 1) {
+            segments = read_pcap(argv[1]);
+            cout << "TCPHeader::parse on the " << segments.size() << " TCP segments in " << argv[1] << ":\n";
+        }
+        if (segments.empty()) {
+            segments = synthetic_segments(10000);
+            cout << "TCPHeader::parse on " << segments.size()
+                 << " synthetic segments (pass a capture, e.g. tests/ipv4_parser.data, to use it instead):\n";
+        }
+
+        parse_all("byte at a time (before)", segments, reference_parse);
+        parse_all("one length check (after)", segments, [](TCPHeader &hdr, const Buffer &seg) {
+            NetParser p{seg};
+            return hdr.parse(p);
+        });
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
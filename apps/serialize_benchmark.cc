@@ -0,0 +1,112 @@
+#include "buffer.hh"
+#include "file_descriptor.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <sys/uio.h>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t reps = 1'000'000;
+
+static size_t allocations = 0;
+
+void *operator new(const size_t size) {
+    allocations++;
+    if (void *ptr = malloc(size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+//! TCPSegment::serialize() as it was first written: the header serialized to a string for the checksum,
+//! and again for the output
+static BufferList reference_serialize(const TCPSegment &seg, const uint32_t datagram_layer_checksum) {
+    TCPHeader header_out = seg.header();
+    header_out.cksum = 0;
+
+    InternetChecksum check(datagram_layer_checksum);
+    check.add(header_out.serialize());
+    check.add_sum(seg.payload_sum());
+    header_out.cksum = check.value();
+
+    BufferList ret;
+    ret.append(header_out.serialize());
+    ret.append(seg.payload());
+    return ret;
+}
+
+//! Serialize `seg` `reps` times and print the allocations and time per segment
+template <typename F>
+static void serialize_all(const string &what, const TCPSegment &seg, F &&serialize) {
+    size_t sink = 0;
+    const size_t before = allocations;
+    const auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < reps; i++) {
+        sink += serialize(seg);
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    cout << "   " << left << setw(34) << what << right << fixed << setprecision(1)
+         << static_cast<double>(allocations - before) / reps << " allocations, "
+         << static_cast<double>(duration) / reps << " ns per segment" << (sink == 0 ? " (?)" : "") << "\n";
+}
+
+int main() {
+    try {
+        TCPSegment seg;
+        seg.header().ack = true;
+        seg.header().seqno = WrappingInt32{12345};
+        seg.header().ackno = WrappingInt32{67890};
+        seg.header().win = 65535;
+        seg.header().options.ts = TCPOptions::Timestamps{1, 2};
+        seg.payload() = string(1400, 'x');
+        const uint32_t pseudo = 0x1234;
+
+        cout << "Serializing a segment with a timestamp option and 1400 bytes of payload:\n";
+        serialize_all("header twice (before)", seg, [&](const TCPSegment &s) {
+            return reference_serialize(s, pseudo).size();
+        });
+        serialize_all("TCPSegment::serialize", seg, [&](const TCPSegment &s) { return s.serialize(pseudo).size(); });
+        serialize_all("serialize_header_into", seg, [&](const TCPSegment &s) {
+            array<uint8_t, TCPHeader::MAX_LENGTH> header;
+            return s.serialize_header_into(header.data(), header.size(), pseudo) + s.payload().size();
+        });
+
+        cout << "Adding IPv4 and Ethernet headers in front:\n";
+        serialize_all("BufferList, one Buffer per layer", seg, [&](const TCPSegment &s) {
+            BufferList ip{string(20, 'i')};
+            ip.append(s.serialize(pseudo));
+            BufferList frame{string(14, 'e')};
+            frame.append(ip);
+            array<iovec, FileDescriptor::IOV_BATCH> iovecs;
+            return BufferViewList{frame}.as_iovecs(iovecs.data(), iovecs.size());
+        });
+        serialize_all("PacketBuffer with headroom", seg, [&](const TCPSegment &s) {
+            PacketBuffer packet = s.serialize_packet(pseudo);
+            memset(packet.prepend(20), 'i', 20);
+            memset(packet.prepend(14), 'e', 14);
+            array<iovec, FileDescriptor::IOV_BATCH> iovecs;
+            return BufferViewList{packet}.as_iovecs(iovecs.data(), iovecs.size());
+        });
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "timer_wheel.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t n_timers = 100000;
+
+//! Arm, re-arm (as when an ACK restarts the RTO), cancel and expire `n_timers` timers
+static void wheel_operations() {
+    mt19937 rng{0};
+    uniform_int_distribution<uint64_t> rto{200, 1200};
+    TimerWheel wheel;
+    size_t fired = 0;
+    vector<unique_ptr<TimerWheel::Timer>> timers;
+    timers.reserve(n_timers);
+    for (size_t i = 0; i < n_timers; i++) {
+        timers.push_back(make_unique<TimerWheel::Timer>([&] { fired++; }));
+    }
+
+    auto start = high_resolution_clock::now();
+    for (auto &timer : timers) {
+        wheel.arm_after(*timer, rto(rng));
+    }
+    const auto arm = high_resolution_clock::now() - start;
+
+    start = high_resolution_clock::now();
+    for (auto &timer : timers) {
+        wheel.arm_after(*timer, rto(rng));
+    }
+    const auto rearm = high_resolution_clock::now() - start;
+
+    start = high_resolution_clock::now();
+    for (size_t i = 0; i < n_timers; i += 2) {
+        timers[i]->cancel();
+    }
+    const auto cancel = high_resolution_clock::now() - start;
+
+    start = high_resolution_clock::now();
+    for (uint64_t ms = 1; ms <= 1200; ms++) {
+        wheel.advance(ms);
+    }
+    const auto expire = high_resolution_clock::now() - start;
+
+    if (fired != n_timers / 2 || wheel.size() != 0) {
+        throw runtime_error("unexpected number of timers expired");
+    }
+
+    const auto per_op = [](const nanoseconds total, const size_t n) {
+        return static_cast<double>(total.count()) / n;
+    };
+    cout << fixed << setprecision(1) << "   " << n_timers << " timers: arm " << per_op(arm, n_timers)
+         << " ns, re-arm " << per_op(rearm, n_timers) << " ns, cancel " << per_op(cancel, n_timers / 2)
+         << " ns, expire " << per_op(expire, fired) << " ns per timer (1200 ms advanced 1 ms at a time)\n";
+}
+
+//! Run `n_timers` mostly idle senders for `seconds` seconds, ticking all of them every `period` ms,
+//! or only when their retransmission timer is due, as scheduled by a TimerWheel
+static void senders(const bool use_wheel, const uint64_t seconds, const uint64_t period) {
+    TCPConfig cfg;
+    cfg.send_capacity = 1024;
+    vector<unique_ptr<TCPSender>> conns;
+    conns.reserve(n_timers);
+    for (size_t i = 0; i < n_timers; i++) {
+        conns.push_back(make_unique<TCPSender>(cfg));
+    }
+
+    // one connection in a hundred has a segment outstanding (a lost SYN)
+    for (size_t i = 0; i < n_timers; i += 100) {
+        conns[i]->fill_window();
+        conns[i]->segments_out().pop();
+    }
+
+    TimerWheel wheel;
+    vector<uint64_t> last_tick(n_timers, 0);
+    vector<unique_ptr<TimerWheel::Timer>> timers;
+    size_t ticks = 0;
+    if (use_wheel) {
+        timers.reserve(n_timers);
+        for (size_t i = 0; i < n_timers; i++) {
+            timers.push_back(make_unique<TimerWheel::Timer>([&, i] {
+                TCPSender &sender = *conns[i];
+                sender.tick(wheel.now() - last_tick[i]);
+                last_tick[i] = wheel.now();
+                ticks++;
+                while (not sender.segments_out().empty()) {
+                    sender.segments_out().pop();
+                }
+                if (sender.next_timeout().has_value()) {
+                    wheel.arm_after(*timers[i], sender.next_timeout().value());
+                }
+            }));
+            if (conns[i]->next_timeout().has_value()) {
+                wheel.arm_after(*timers[i], conns[i]->next_timeout().value());
+            }
+        }
+    }
+
+    const auto start = high_resolution_clock::now();
+    for (uint64_t now = period; now <= seconds * 1000; now += period) {
+        if (use_wheel) {
+            wheel.advance(now);
+            continue;
+        }
+        for (auto &sender : conns) {
+            sender->tick(period);
+            ticks++;
+            while (not sender->segments_out().empty()) {
+                sender->segments_out().pop();
+            }
+        }
+    }
+    const auto duration = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+
+    cout << "   " << n_timers << " senders, " << seconds << " s"
+         << (use_wheel ? " on a timer wheel:  " : " ticked every " + to_string(period) + " ms: ") << fixed
+         << setprecision(3) << static_cast<double>(duration) / 1e6 / seconds << " ms per simulated second (" << ticks << " ticks)\n";
+}
+
+int main() {
+    try {
+        wheel_operations();
+        senders(false, 10, 5);
+        senders(true, 10, 5);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
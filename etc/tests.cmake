@@ -7,12 +7,30 @@ add_test(NAME t_wrapping_ints_unwrap      COMMAND wrapping_integers_unwrap)
 add_test(NAME t_wrapping_ints_wrap        COMMAND wrapping_integers_wrap)
 add_test(NAME t_wrapping_ints_roundtrip   COMMAND wrapping_integers_roundtrip)
 
+add_test(NAME t_timer_wheel          COMMAND timer_wheel)
+add_test(NAME t_tcp_isn              COMMAND tcp_isn)
+add_test(NAME t_clock                COMMAND clock)
+add_test(NAME t_checksum             COMMAND checksum)
+add_test(NAME t_tcp_header_view      COMMAND tcp_header_view)
+add_test(NAME t_tcp_serialize        COMMAND tcp_serialize)
+add_test(NAME t_packet_buffer        COMMAND packet_buffer)
+add_test(NAME t_buffer               COMMAND buffer)
+add_test(NAME t_buffer_pool          COMMAND buffer_pool)
+add_test(NAME t_block_buffer         COMMAND block_buffer)
+add_test(NAME t_huge_page_arena      COMMAND huge_page_arena)
+
 add_test(NAME t_recv_connect         COMMAND recv_connect)
 add_test(NAME t_recv_transmit        COMMAND recv_transmit)
 add_test(NAME t_recv_window          COMMAND recv_window)
 add_test(NAME t_recv_reorder         COMMAND recv_reorder)
 add_test(NAME t_recv_close           COMMAND recv_close)
 add_test(NAME t_recv_special         COMMAND recv_special)
+add_test(NAME t_recv_paws            COMMAND recv_paws)
+add_test(NAME t_recv_delack          COMMAND recv_delack)
+add_test(NAME t_recv_autotune        COMMAND recv_autotune)
+add_test(NAME t_recv_gro             COMMAND recv_gro)
+add_test(NAME t_recv_trim            COMMAND recv_trim)
+add_test(NAME t_recv_ecn             COMMAND recv_ecn)
 
 add_test(NAME t_send_connect         COMMAND send_connect)
 add_test(NAME t_send_transmit        COMMAND send_transmit)
@@ -21,6 +39,10 @@ add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
 add_test(NAME t_send_extra           COMMAND send_extra)
+add_test(NAME t_send_mss             COMMAND send_mss)
+add_test(NAME t_send_sws             COMMAND send_sws)
+add_test(NAME t_send_ecn             COMMAND send_ecn)
+add_test(NAME t_send_timestamps      COMMAND send_timestamps)
 
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
 add_test(NAME t_strm_reassem_seq         COMMAND fsm_stream_reassembler_seq)
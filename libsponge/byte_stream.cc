@@ -1,5 +1,10 @@
 #include "byte_stream.hh"
 
+#include "checksum.hh"
+
+#include <algorithm>
+#include <utility>
+
 // Dummy implementation of a flow-controlled in-memory byte stream.
 
 // For Lab 0, please replace with a real implementation that passes the
@@ -14,30 +19,45 @@ using namespace std;
 
 ByteStream::ByteStream(const size_t capacity) { _capacity = capacity; }
 
-size_t ByteStream::write(const string &data) {
+size_t ByteStream::write(string_view data) {
     if (!_allowin || _error) {
         _error = true;
         return 0;
     }
-    size_t bytes_write = data.size() > _capacity - _buffer.size() ? _capacity - _buffer.size() : data.size();
+    size_t bytes_write = min(data.size(), remaining_capacity());
 
-    _buffer += data.substr(0, bytes_write);
+    _buffer.write(_bytesin, data.substr(0, bytes_write));
 
     _bytesin += bytes_write;
     return bytes_write;
 }
 
+//! \param[in] data the bytes to write
+//! \param[in] sum the sum they are expected to have
+bool ByteStream::write_checked(string_view data, const uint16_t sum) {
+    if (!_allowin || _error || data.size() > remaining_capacity()) {
+        return false;
+    }
+    const uint16_t actual = _buffer.write_and_sum(_bytesin, data);
+    if (not ChecksumKernel::equal(actual, sum)) {
+        _buffer.keep(_bytesout, _bytesin);
+        return false;
+    }
+    _bytesin += data.size();
+    return true;
+}
+
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
-    string ret = _buffer.substr(0, len);
+    string ret(min(len, buffer_size()), '\0');
+    _buffer.read(_bytesout, ret.data(), ret.size());
     return ret;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
 void ByteStream::pop_output(const size_t len) {
-    size_t before = _buffer.size();
-    _buffer = _buffer.substr(len);
-    _bytesout += before - _buffer.size();
+    _bytesout += min(len, buffer_size());
+    _buffer.keep(_bytesout, _bytesin);
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
@@ -50,18 +70,33 @@ std::string ByteStream::read(const size_t len) {
     return ret;
 }
 
+//! \param[in] len bytes will be popped and returned
+//! \param[out] sum the one's-complement sum of the bytes returned
+//! \returns a Buffer
+Buffer ByteStream::read(const size_t len, uint16_t &sum) {
+    const size_t n = min(len, buffer_size());
+    BufferStorage::Ptr block = BufferPool::allocate(n);
+    sum = _buffer.read_and_sum(_bytesout, block->data(), n);
+    pop_output(n);
+
+    return Buffer{std::move(block)};
+}
+
 void ByteStream::end_input() { _allowin = false; }
 
 bool ByteStream::input_ended() const { return !_allowin; }
 
-size_t ByteStream::buffer_size() const { return _buffer.size(); }
+size_t ByteStream::buffer_size() const { return _bytesin - _bytesout; }
 
-bool ByteStream::buffer_empty() const { return _buffer.empty(); }
+bool ByteStream::buffer_empty() const { return buffer_size() == 0; }
 
-bool ByteStream::eof() const { return _buffer.size() == 0 && !_allowin; }
+bool ByteStream::eof() const { return buffer_empty() && !_allowin; }
 
 size_t ByteStream::bytes_written() const { return _bytesin; }
 
 size_t ByteStream::bytes_read() const { return _bytesout; }
 
-size_t ByteStream::remaining_capacity() const { return _capacity - _buffer.size(); }
+size_t ByteStream::remaining_capacity() const { return _capacity - buffer_size(); }
+
+//! \param[in] capacity the new capacity, which is raised to buffer_size() if it is smaller
+void ByteStream::set_capacity(const size_t capacity) { _capacity = max(capacity, buffer_size()); }
@@ -1,7 +1,12 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
+#include "block_buffer.hh"
+#include "buffer.hh"
+
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 //! \brief An in-order byte stream.
 
@@ -20,7 +25,7 @@ class ByteStream {
     bool _error{};  //!< Flag indicating that the stream suffered an error.
     bool _allowin{true};
     bool _allowout{true};
-    std::string _buffer{};
+    BlockBuffer _buffer{};  //!< the bytes between bytes_read() and bytes_written(), at their stream index
     size_t _capacity{};
     size_t _bytesin{};
     size_t _bytesout{};
@@ -35,11 +40,24 @@ class ByteStream {
     //! Write a string of bytes into the stream. Write as many
     //! as will fit, and return how many were written.
     //! \returns the number of bytes accepted into the stream
-    size_t write(const std::string &data);
+    size_t write(std::string_view data);
+
+    //! Write all of `data`, provided that the one's-complement sum of its bytes (see ChecksumKernel)
+    //! is `sum`, summing the bytes as they are copied.
+    //! \returns `false`, having written nothing, if the sum differs or `data` does not fit
+    bool write_checked(std::string_view data, const uint16_t sum);
 
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
+    //! \returns the maximum number of bytes the stream will buffer
+    size_t capacity() const { return _capacity; }
+
+    //! Grow or shrink the stream's capacity (never below the bytes already buffered)
+    //! \note The stream holds blocks only for the bytes it buffers (see BlockBuffer), which it frees as
+    //! they are popped, so the capacity limits its memory without reserving it.
+    void set_capacity(const size_t capacity);
+
     //! Signal that the byte stream has reached its ending
     void end_input();
 
@@ -61,6 +79,11 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read the next "len" bytes of the stream, and set `sum` to their one's-complement sum
+    //! (see ChecksumKernel), computed as they are copied
+    //! \returns a Buffer, in a block from the BufferPool
+    Buffer read(const size_t len, uint16_t &sum);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
@@ -1,5 +1,10 @@
 #include "stream_reassembler.hh"
 
+#include "checksum.hh"
+#include "small_vector.hh"
+
+#include <algorithm>
+
 // Dummy implementation of a stream reassembler.
 
 // For Lab 1, please replace with a real implementation that passes the
@@ -13,116 +18,155 @@ void DUMMY_CODE(Targs &&.../* unused */) {}
 using namespace std;
 
 StreamReassembler::StreamReassembler(const size_t capacity)
-    : _output(capacity), _capacity(capacity), _unassembled(), _unassembled_bytes(), _next(0), _eof(SIZE_MAX) {}
-
-void StreamReassembler::__push_to_list(const string &data, const size_t index) {
-    auto left = index, right = data.size() + index;
-
-    // find the first one that may overlap with [data]
-    auto iter = _unassembled.begin();
-    while (iter != _unassembled.end() && iter->first + iter->second.size() < left) {
-        iter++;
-    }
-
-    // 1. there's no conflict because end of string
-    if (iter == _unassembled.end()) {
-        _unassembled.push_back(make_pair(index, data));
-        _unassembled_bytes += data.size();
-        return;
+    : _output(capacity)
+    , _capacity(capacity)
+    , _unassembled()
+    , _ranges()
+    , _unassembled_bytes()
+    , _next(0)
+    , _eof(SIZE_MAX) {}
+
+void StreamReassembler::add_range(const size_t first, const size_t last) {
+    // the first range that ends at or after `first`, and the first that starts after `last`
+    const auto ends_before = [](const pair<size_t, size_t> &range, const size_t i) { return range.second < i; };
+    auto start = lower_bound(_ranges.begin(), _ranges.end(), first, ends_before);
+    auto stop = start;
+    size_t merged_first = first, merged_last = last;
+    for (; stop != _ranges.end() && stop->first <= last; stop++) {
+        merged_first = min(merged_first, stop->first);
+        merged_last = max(merged_last, stop->second);
+        _unassembled_bytes -= stop->second - stop->first;
     }
+    start = _ranges.erase(start, stop);
+    _ranges.insert(start, {merged_first, merged_last});
+    _unassembled_bytes += merged_last - merged_first;
+}
 
-    // 2. there's no conflict because it fills the gap
-    if (iter->first > right) {
-        _unassembled.insert(iter, make_pair(index, data));
-        _unassembled_bytes += data.size();
+void StreamReassembler::assemble() {
+    if (_ranges.empty() || _ranges.front().first > _next) {
         return;
     }
-
-    // 3. there's conflict
-    //  1) loop through all the pairs that conflict with this string, merge them.
-    string merged = data;
-    size_t merged_idx = index;
-    auto start = iter;
-    while (iter != _unassembled.end() && iter->first <= right) {
-        auto ileft = iter->first, iright = iter->first + iter->second.size();
-        if (ileft < left) {
-            merged = iter->second.substr(0, left - ileft) + merged;
-            merged_idx = ileft;
-        }
-        if (right < iright) {
-            merged = merged + iter->second.substr(iter->second.size() - iright + right);
-        }
-        _unassembled_bytes -= iter->second.size();
-        iter++;
-    }
-    //  2) erase all conflict element
-    _unassembled.erase(start, iter);
-    //  3) insert the new merged string
-    _unassembled_bytes += merged.size();
-    _unassembled.insert(iter, make_pair(merged_idx, merged));
-}
-
-void StreamReassembler::__reduce(const size_t amount) {
-    // get the end of list
-    auto iter = _unassembled.end();
-    iter--;
-    auto cnt = amount;
-
-    while (_unassembled.size()) {
-        if (iter->second.size() <= cnt) {
-            // remove the element
-            cnt -= iter->second.size();
-            _unassembled.erase(iter--);
-        } else {
-            // squash the element
-            iter->second = iter->second.substr(0, iter->second.size() - cnt);
+    const size_t last = _ranges.front().second;
+    while (_next < last) {
+        const string_view piece = _unassembled.contiguous(_next, last - _next);
+        const size_t written = _output.write(piece);
+        _next += written;
+        _unassembled_bytes -= written;
+        if (written < piece.size()) {
             break;
         }
     }
+    if (_next == last) {
+        _ranges.erase(_ranges.begin());
+    } else {
+        _ranges.front().first = _next;
+    }
+    _unassembled.keep(_next, _ranges.empty() ? _next : _ranges.back().second);
 }
 
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
-void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    // Useless string
-    if (_next > data.size() + index) {
-        return;
-    }
+void StreamReassembler::push_substring(string_view data, const size_t index, const bool eof) {
+    push_pieces(&data, 1, index, eof);
+}
 
-    if (eof) {
-        _eof = index + data.size();
+void StreamReassembler::push_buffers(const BufferList &data, const uint64_t index, const bool eof) {
+    SmallVector<string_view, BufferList::INLINE_BUFFERS> pieces;
+    for (const Buffer &buffer : data.buffers()) {
+        pieces.push_back(buffer.str());
     }
+    push_pieces(pieces.data(), pieces.size(), index, eof);
+}
 
-    if (index < _next) {
-        __push_to_list(data.substr(_next - index), _next);
-    } else {
-        __push_to_list(data, index);
-    }
-    if (_unassembled_bytes + _output.buffer_size() > _capacity) {
-        __reduce(_unassembled_bytes + _output.buffer_size() - _capacity);
-        _unassembled_bytes = _capacity - _output.buffer_size();
+void StreamReassembler::push_pieces(const string_view *pieces, const size_t count, const size_t index, const bool eof) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        size += pieces[i].size();
     }
 
-    if (_unassembled.size() == 0) {
+    // Useless string
+    if (_next > size + index) {
         return;
     }
 
-    auto elem = _unassembled.front();
+    if (eof) {
+        _eof = index + size;
+    }
 
-    if (elem.first > _next)
+    // fast path: in-order data with nothing waiting goes straight into the stream
+    if (index <= _next && _ranges.empty()) {
+        size_t piece_index = index;
+        for (size_t i = 0; i < count; i++) {
+            const size_t piece_end = piece_index + pieces[i].size();
+            if (piece_end > _next) {
+                _next += _output.write(pieces[i].substr(_next - piece_index));
+                if (_next < piece_end) {
+                    break;  // the stream is full
+                }
+            }
+            piece_index = piece_end;
+        }
+        if (_next >= _eof) {
+            _output.end_input();
+        }
         return;
+    }
 
-    _output.write(elem.second.substr(_next - elem.first));
-    _next = elem.first + elem.second.size();
-    _unassembled.pop_front();
-    _unassembled_bytes -= elem.second.size();
+    // keep what fits in the window, [_next, _next + the room left in the stream)
+    const size_t first = max(index, _next);
+    const size_t last = min(index + size, _next + _output.remaining_capacity());
+    if (first < last) {
+        if (_ranges.empty()) {
+            _unassembled.keep(_next, _next);  // the fast paths may have moved _next on since the last keep()
+        }
+        size_t piece_index = index;
+        for (size_t i = 0; i < count && piece_index < last; piece_index += pieces[i++].size()) {
+            const size_t piece_first = max(piece_index, first);
+            const size_t piece_last = min(piece_index + pieces[i].size(), last);
+            if (piece_first < piece_last) {
+                _unassembled.write(piece_first, pieces[i].substr(piece_first - piece_index, piece_last - piece_first));
+            }
+        }
+        add_range(first, last);
+    }
+    assemble();
 
     if (_next >= _eof) {
         _output.end_input();
     }
 }
 
+bool StreamReassembler::push_checked(string_view data, const uint64_t index, const bool eof, const uint16_t sum) {
+    const bool fits = data.size() <= _output.remaining_capacity() && not _output.input_ended() && not _output.error();
+    if (index == _next && _ranges.empty() && not data.empty() && fits) {
+        if (not _output.write_checked(data, sum)) {
+            return false;
+        }
+        _next += data.size();
+        if (eof) {
+            _eof = _next;
+        }
+        if (_next >= _eof) {
+            _output.end_input();
+        }
+        return true;
+    }
+
+    const uint16_t actual = ChecksumKernel::sum(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    if (not ChecksumKernel::equal(actual, sum)) {
+        return false;
+    }
+    push_substring(data, index, eof);
+    return true;
+}
+
 size_t StreamReassembler::unassembled_bytes() const { return _unassembled_bytes; }
 
-bool StreamReassembler::empty() const { return _unassembled.empty() && _output.buffer_empty(); }
+//! \param[in] capacity the new capacity for both the reassembler and its output stream
+void StreamReassembler::set_capacity(const size_t capacity) {
+    _capacity = max(capacity, _unassembled_bytes + _output.buffer_size());
+    _output.set_capacity(_capacity);
+}
+
+bool StreamReassembler::empty() const { return _ranges.empty() && _output.buffer_empty(); }
@@ -1,13 +1,15 @@
 #ifndef SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
+#include "block_buffer.hh"
+#include "buffer.hh"
 #include "byte_stream.hh"
 
 #include <cstdint>
 #include <iostream>
-#include <list>
-#include <queue>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
@@ -19,13 +21,20 @@ class StreamReassembler {
     ByteStream _output;  //!< The reassembled in-order byte stream
     size_t _capacity;    //!< The maximum number of bytes
 
-    std::list<std::pair<size_t, std::string>> _unassembled;  // !< The unassembled list
+    BlockBuffer _unassembled;                        //!< The bytes not yet assembled, at their index
+    std::vector<std::pair<size_t, size_t>> _ranges;  //!< The [first, last) index ranges held, sorted and apart
     size_t _unassembled_bytes;
     size_t _next;      //!< The next index to be assembled (once this index is pushed, should assemble some strings)
     size_t _eof;       //!< The index of the end of the stream
 
-    void __push_to_list(const std::string &data, const size_t index);
-    void __reduce(const size_t amount);
+    //! Record that the bytes [first, last) are held, merging with the ranges they overlap or touch
+    void add_range(const size_t first, const size_t last);
+
+    //! Write the bytes held from _next on (as many as fit) to the stream, and free the blocks they leave
+    void assemble();
+
+    //! Push the bytes of `pieces`, which follow one another from `index` on, as one substring
+    void push_pieces(const std::string_view *pieces, const size_t count, const uint64_t index, const bool eof);
 
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
@@ -36,12 +45,25 @@ class StreamReassembler {
     //! \brief Receive a substring and write any newly contiguous bytes into the stream.
     //!
     //! The StreamReassembler will stay within the memory limits of the `capacity`.
-    //! Bytes that would exceed the capacity are silently discarded.
+    //! Bytes that would exceed the capacity are silently discarded. In-order data that
+    //! arrives while nothing is waiting to be reassembled is copied straight into the stream;
+    //! anything else (within the window of the capacity) is copied into a BlockBuffer at its
+    //! index, to be written to the stream once the bytes before it arrive.
     //!
     //! \param data the substring
     //! \param index indicates the index (place in sequence) of the first byte in `data`
     //! \param eof the last byte of `data` will be the last byte in the entire stream
-    void push_substring(const std::string &data, const uint64_t index, const bool eof);
+    void push_substring(std::string_view data, const uint64_t index, const bool eof);
+
+    //! \brief As push_substring(), for a substring held in pieces (e.g., a run of coalesced segments)
+    //! \details The pieces are clipped to the window, held and assembled together, as if they were contiguous.
+    void push_buffers(const BufferList &data, const uint64_t index, const bool eof);
+
+    //! \brief As push_substring(), but only if the one's-complement sum of `data` (see ChecksumKernel) is `sum`
+    //! \details On the fast path (in-order data, nothing waiting, room for all of it), the bytes are summed
+    //! as they are copied into the stream; otherwise they are summed first.
+    //! \returns `false`, having changed nothing, if the sum differs
+    bool push_checked(std::string_view data, const uint64_t index, const bool eof, const uint16_t sum);
 
     //! \name Access the reassembled byte stream
     //!@{
@@ -55,6 +77,13 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! \returns the maximum number of bytes held, reassembled or not
+    size_t capacity() const { return _capacity; }
+
+    //! \brief Grow or shrink the capacity of the reassembler and its output stream
+    //! \note The capacity is never reduced below the bytes currently held, so nothing is discarded.
+    void set_capacity(const size_t capacity);
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
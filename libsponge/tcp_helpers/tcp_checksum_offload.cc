@@ -0,0 +1,35 @@
+#include "tcp_checksum_offload.hh"
+
+using namespace std;
+
+//! \param[in] seg the segment to parse into
+//! \param[in] buffer string/Buffer to be parsed
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+//! \param[in] defer_payload_checksum with ChecksumPolicy::Verify, leave the payload to be verified when it is copied
+ParseResult TCPChecksumOffload::parse(TCPSegment &seg,
+                                      const Buffer buffer,
+                                      const uint32_t datagram_layer_checksum,
+                                      const bool defer_payload_checksum) {
+    if (_policy != ChecksumPolicy::Verify) {
+        _stats.skipped++;
+        return seg.parse_unverified(buffer);
+    }
+    const ParseResult ret = seg.parse(buffer, datagram_layer_checksum, defer_payload_checksum);
+    if (seg.payload_verified()) {
+        _stats.verified++;
+    } else {
+        _stats.deferred++;
+    }
+    return ret;
+}
+
+//! \param[in] seg the segment to serialize
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+BufferList TCPChecksumOffload::serialize(const TCPSegment &seg, const uint32_t datagram_layer_checksum) {
+    if (_policy == ChecksumPolicy::PartialOffload) {
+        _stats.partial++;
+        return seg.serialize_partial(datagram_layer_checksum);
+    }
+    _stats.computed++;
+    return seg.serialize(datagram_layer_checksum);
+}
@@ -0,0 +1,53 @@
+#ifndef SPONGE_LIBSPONGE_TCP_CHECKSUM_OFFLOAD_HH
+#define SPONGE_LIBSPONGE_TCP_CHECKSUM_OFFLOAD_HH
+
+#include "buffer.hh"
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+
+//! \brief Parses and serializes the TCPSegment%s of one interface according to its ChecksumPolicy
+//!
+//! A TUN device with a virtio-net header, or an in-process loopback, hands over segments whose
+//! checksums the kernel or the peer has already validated, and can complete outgoing checksums
+//! itself. On such an interface, summing every payload again is wasted work; everywhere else,
+//! the default policy (ChecksumPolicy::Verify) behaves exactly like TCPSegment::parse() and
+//! TCPSegment::serialize(). The counters show which path each segment took.
+class TCPChecksumOffload {
+  public:
+    //! How the checksums of received and sent segments were handled
+    struct Stats {
+        size_t verified{0};  //!< received segments whose checksum was verified in parse()
+        size_t deferred{0};  //!< received segments left to be verified when their payload is copied
+        size_t skipped{0};   //!< received segments accepted unverified
+        size_t computed{0};  //!< sent segments with a complete checksum
+        size_t partial{0};   //!< sent segments with just the pseudo-header sum, for the device to complete
+    };
+
+  private:
+    ChecksumPolicy _policy;
+    Stats _stats{};
+
+  public:
+    //! Handle checksums according to `policy`
+    explicit TCPChecksumOffload(const ChecksumPolicy policy = ChecksumPolicy::Verify) : _policy(policy) {}
+
+    //! \brief Parse `seg` from `buffer`, verifying its checksum unless the policy says not to
+    ParseResult parse(TCPSegment &seg,
+                      const Buffer buffer,
+                      const uint32_t datagram_layer_checksum = 0,
+                      const bool defer_payload_checksum = false);
+
+    //! \brief Serialize `seg`, with a complete checksum or a partial one, as the policy says
+    BufferList serialize(const TCPSegment &seg, const uint32_t datagram_layer_checksum = 0);
+
+    //! \brief The interface's policy
+    ChecksumPolicy policy() const { return _policy; }
+
+    //! \brief How the checksums of received and sent segments were handled
+    const Stats &stats() const { return _stats; }
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_CHECKSUM_OFFLOAD_HH
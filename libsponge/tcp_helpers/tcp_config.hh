@@ -13,13 +13,35 @@ class TCPConfig {
   public:
     static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
     static constexpr size_t MAX_PAYLOAD_SIZE = 1452;   //!< Max TCP payload that fits in either IPv4 or UDP datagram
+    static constexpr size_t MIN_MSS = 64;              //!< Smallest MSS we will accept from a peer
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    static constexpr uint16_t MIN_RTO = 200;           //!< Lower bound on an RTO computed from RTT samples
+    static constexpr uint16_t MAX_RTO = 60000;         //!< Upper bound on an RTO computed from RTT samples
+    static constexpr unsigned QUICKACK_DFLT = 16;      //!< Segments ACKed immediately at connection start
+    static constexpr uint16_t SWS_OVERRIDE = 200;      //!< Sender: send held-back data after this many ms idle
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
+    size_t recv_capacity_max = 0;             //!< Auto-tune receive capacity up to this many bytes (0: fixed)
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
-    std::optional<WrappingInt32> fixed_isn{};
+    uint16_t mss = MAX_PAYLOAD_SIZE;          //!< MSS advertised in our SYN (set from the path MTU), in bytes
+    bool timestamps = false;                  //!< Offer [RFC 7323](\ref rfc::rfc7323) timestamps in our SYN
+    uint16_t delack_timeout = 0;              //!< Delayed-ACK timer in milliseconds (0: ACK every segment)
+    unsigned quickack = QUICKACK_DFLT;        //!< With delayed ACKs, number of segments to ACK immediately at first
+    bool sws_avoidance = false;               //!< Receiver: only open the window by at least min(MSS, capacity / 2)
+    bool nagle = false;                       //!< Sender: hold back small segments while data is unacknowledged
+    bool ecn = false;                         //!< Offer [RFC 3168](\ref rfc::rfc3168) ECN in our SYN
+    bool dctcp = false;                       //!< With ECN, respond to marks as DCTCP ([RFC 8257](\ref rfc::rfc8257))
+    std::optional<WrappingInt32> fixed_isn{};  //!< ISN to use, e.g. from ISNGenerator::isn(local, remote)
+};
+
+//! \brief How an interface handles TCP checksums (see TCPChecksumOffload)
+enum class ChecksumPolicy {
+    Verify,          //!< Compute the checksum on send and verify it on receive
+    SkipVerify,      //!< Compute it on send; accept received segments unverified (e.g., in-process loopback)
+    PartialOffload,  //!< Accept received segments unverified; on send, store only the pseudo-header sum
+                     //!< for the device to complete (as with a virtio-net header's NEEDS_CSUM)
 };
 
 //! Config for classes derived from FdAdapter
@@ -30,6 +52,9 @@ class FdAdapterConfig {
 
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
+
+    //! Checksum handling: only skip verification if the device or peer has already checked every segment
+    ChecksumPolicy checksum = ChecksumPolicy::Verify;
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_CONFIG_HH
@@ -0,0 +1,75 @@
+#include "tcp_gro.hh"
+
+#include <utility>
+
+using namespace std;
+
+size_t TCPSegmentRun::length_in_sequence_space() const {
+    return payload.size() + (header.syn ? 1 : 0) + (header.fin ? 1 : 0);
+}
+
+//! \param[in] run the run being built, which is still open
+//! \param[in] seg the next segment of the batch
+//! \returns `true` if `seg` continues `run` and carries the same ACK, window and timestamps
+bool TCPSegmentCoalescer::can_merge(const TCPSegmentRun &run, const TCPSegment &seg) {
+    const TCPHeader &first = run.header;
+    const TCPHeader &next = seg.header();
+    const size_t len = seg.payload().size();
+
+    if (next.syn || next.rst || next.urg || next.cwr || len == 0 || len > run.segment_size) {
+        return false;
+    }
+    if (next.seqno != first.seqno + run.payload.size() || run.payload.size() + len > MAX_RUN_BYTES) {
+        return false;
+    }
+    if (next.ack != first.ack || next.ackno != first.ackno || next.win != first.win || next.ece != first.ece) {
+        return false;
+    }
+    if (next.options.num_sack_blocks || next.options.ts.has_value() != first.options.ts.has_value()) {
+        return false;
+    }
+    return not next.options.ts.has_value() || (next.options.ts.value().val == first.options.ts.value().val &&
+                                                next.options.ts.value().ecr == first.options.ts.value().ecr);
+}
+
+//! \param[in] batch the segments received for one connection, in arrival order
+//! \details Segments that cannot be merged become runs of one, so the runs cover the whole
+//!          batch in order (less any segment whose deferred checksum is wrong).
+const vector<TCPSegmentRun> &TCPSegmentCoalescer::coalesce(const vector<TCPSegment> &batch) {
+    _runs.clear();
+    bool open = false;
+
+    for (const TCPSegment &seg : batch) {
+        const TCPHeader &hdr = seg.header();
+        const size_t len = seg.payload().size();
+
+        // a run no longer knows where its segments' checksums end, so any left unverified are checked here
+        if (not seg.payload_valid()) {
+            _stats.bad_checksums++;
+            continue;
+        }
+
+        if (open && can_merge(_runs.back(), seg)) {
+            TCPSegmentRun &run = _runs.back();
+            run.payload.append(seg.payload());
+            run.segments++;
+            run.header.psh |= hdr.psh;
+            run.header.fin = hdr.fin;
+            open = not(hdr.psh || hdr.fin || len < run.segment_size);
+            continue;
+        }
+
+        TCPSegmentRun run;
+        run.header = hdr;
+        run.payload = seg.payload();
+        run.segments = 1;
+        run.segment_size = len;
+        _runs.push_back(move(run));
+        open = len > 0 && not(hdr.syn || hdr.fin || hdr.rst || hdr.urg || hdr.psh) &&
+               hdr.options.num_sack_blocks == 0;
+    }
+
+    _stats.segments += batch.size();
+    _stats.runs += _runs.size();
+    return _runs;
+}
@@ -0,0 +1,59 @@
+#ifndef SPONGE_LIBSPONGE_TCP_GRO_HH
+#define SPONGE_LIBSPONGE_TCP_GRO_HH
+
+#include "buffer.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstddef>
+#include <vector>
+
+//! \brief A run of consecutive, in-order TCPSegment%s merged into one logical segment
+struct TCPSegmentRun {
+    TCPHeader header{};       //!< header of the first segment, with PSH and FIN from the last
+    BufferList payload{};     //!< the segments' payloads, chained without copying
+    size_t segments = 0;      //!< number of segments merged into the run
+    size_t segment_size = 0;  //!< payload size of every segment but (possibly) the last
+
+    //! \brief Run's length in sequence space
+    size_t length_in_sequence_space() const;
+};
+
+//! \brief Receive-side segment coalescing ("software GRO")
+//!
+//! Takes a batch of parsed segments for one connection (e.g., everything read in one poll cycle)
+//! and merges runs of consecutive, in-order segments into TCPSegmentRun%s, so that the TCPReceiver
+//! pays for one `unwrap`, one copy and one reassembly per run instead of per segment.
+//!
+//! Like Linux's `tcp_gro_receive`, only data segments with identical ACK fields, window, ECE flag
+//! and timestamps are merged, and a run ends after a segment shorter than the first, or one that
+//! carries PSH or FIN. SYN, RST, URG and CWR segments are not merged into a run. The batch should
+//! not mix datagrams with and without a CE mark, since a run is passed on with a single mark.
+class TCPSegmentCoalescer {
+  public:
+    static constexpr size_t MAX_RUN_BYTES = 65535;  //!< Largest payload of a merged run
+
+    //! Counters describing how well segments were coalesced
+    struct Stats {
+        size_t segments{0};       //!< segments passed to coalesce()
+        size_t runs{0};           //!< runs produced
+        size_t bad_checksums{0};  //!< segments dropped because their deferred checksum was wrong
+    };
+
+  private:
+    std::vector<TCPSegmentRun> _runs{};
+    Stats _stats{};
+
+    //! Can `seg` be appended to `run`?
+    static bool can_merge(const TCPSegmentRun &run, const TCPSegment &seg);
+
+  public:
+    //! \brief Merge a batch of segments (in arrival order) into runs
+    //! \returns the runs, valid until the next call
+    const std::vector<TCPSegmentRun> &coalesce(const std::vector<TCPSegment> &batch);
+
+    //! \brief Counters describing how well segments were coalesced
+    const Stats &stats() const { return _stats; }
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_GRO_HH
@@ -1,5 +1,8 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <sstream>
 
 using namespace std;
@@ -15,13 +18,21 @@ using namespace std;
 //! - there is less data in the header than the `doff` field claims
 //! - the checksum is bad
 ParseResult TCPHeader::parse(NetParser &p) {
-    sport = p.u16();                 // source port
-    dport = p.u16();                 // destination port
-    seqno = WrappingInt32{p.u32()};  // sequence number
-    ackno = WrappingInt32{p.u32()};  // ack number
-    doff = p.u8() >> 4;              // data offset
+    // the fixed part of the header: one length check, then plain loads
+    const uint8_t *h = p.peek(TCPHeader::LENGTH);
+    if (not h) {
+        return p.get_error();
+    }
 
-    const uint8_t fl_b = p.u8();                  // byte including flags
+    sport = NetParser::load_u16(h);                     // source port
+    dport = NetParser::load_u16(h + 2);                 // destination port
+    seqno = WrappingInt32{NetParser::load_u32(h + 4)};  // sequence number
+    ackno = WrappingInt32{NetParser::load_u32(h + 8)};  // ack number
+    doff = h[12] >> 4;                                  // data offset
+
+    const uint8_t fl_b = h[13];                   // byte including flags
+    cwr = static_cast<bool>(fl_b & 0b1000'0000);
+    ece = static_cast<bool>(fl_b & 0b0100'0000);
     urg = static_cast<bool>(fl_b & 0b0010'0000);  // binary literals and ' digit separator since C++14!!!
     ack = static_cast<bool>(fl_b & 0b0001'0000);
     psh = static_cast<bool>(fl_b & 0b0000'1000);
@@ -29,52 +40,62 @@ ParseResult TCPHeader::parse(NetParser &p) {
     syn = static_cast<bool>(fl_b & 0b0000'0010);
     fin = static_cast<bool>(fl_b & 0b0000'0001);
 
-    win = p.u16();    // window size
-    cksum = p.u16();  // checksum
-    uptr = p.u16();   // urgent pointer
+    win = NetParser::load_u16(h + 14);    // window size
+    cksum = NetParser::load_u16(h + 16);  // checksum
+    uptr = NetParser::load_u16(h + 18);   // urgent pointer
+
+    p.remove_prefix(TCPHeader::LENGTH);
 
     if (doff < 5) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
-
-    if (p.error()) {
-        return p.get_error();
-    }
-
-    return ParseResult::NoError;
+    // decode the options that fill out the rest of the header
+    return options.parse(p, doff * 4 - TCPHeader::LENGTH);
 }
 
 //! Serialize the TCPHeader to a string (does not recompute the checksum)
 string TCPHeader::serialize() const {
+    array<uint8_t, MAX_LENGTH> out;
+    const size_t len = serialize_into(out.data(), out.size());
+    return {reinterpret_cast<const char *>(out.data()), len};
+}
+
+//! \param[out] out where to write the header
+//! \param[in] len room at `out`, in bytes
+//! \details Every field goes at its fixed offset; the checksum is written as it is, not recomputed.
+size_t TCPHeader::serialize_into(uint8_t *out, const size_t len) const {
     // sanity check
     if (doff < 5) {
         throw runtime_error("TCP header too short");
     }
 
-    string ret;
-    ret.reserve(4 * doff);
-
-    NetUnparser::u16(ret, sport);              // source port
-    NetUnparser::u16(ret, dport);              // destination port
-    NetUnparser::u32(ret, seqno.raw_value());  // sequence number
-    NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
-
-    const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
-                         (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
-    NetUnparser::u8(ret, fl_b);  // flags
-    NetUnparser::u16(ret, win);  // window size
+    array<uint8_t, TCPOptions::MAX_LENGTH> opts;
+    const size_t options_length = options.serialize_into(opts.data(), opts.size());
+    const uint8_t doff_out = max<size_t>(doff, (TCPHeader::LENGTH + options_length) / 4);
+    const size_t length = 4 * doff_out;
+    if (length > len) {
+        throw runtime_error("TCPHeader::serialize_into: not enough room");
+    }
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::store_u16(out, sport);                  // source port
+    NetUnparser::store_u16(out + 2, dport);              // destination port
+    NetUnparser::store_u32(out + 4, seqno.raw_value());  // sequence number
+    NetUnparser::store_u32(out + 8, ackno.raw_value());  // ack number
+    out[12] = doff_out << 4;                             // data offset
 
-    NetUnparser::u16(ret, uptr);  // urgent pointer
+    out[13] = (cwr ? 0b1000'0000 : 0) | (ece ? 0b0100'0000 : 0) | (urg ? 0b0010'0000 : 0) |
+              (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) | (rst ? 0b0000'0100 : 0) |
+              (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);  // flags
+    NetUnparser::store_u16(out + 14, win);                        // window size
+    NetUnparser::store_u16(out + 16, cksum);                      // checksum
+    NetUnparser::store_u16(out + 18, uptr);                       // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    // options, padded to a multiple of four bytes, then zeros up to the advertised size
+    memcpy(out + TCPHeader::LENGTH, opts.data(), options_length);
+    memset(out + TCPHeader::LENGTH + options_length, 0, length - TCPHeader::LENGTH - options_length);
 
-    return ret;
+    return length;
 }
 
 //! \returns A string with the header's contents
@@ -85,24 +106,25 @@ string TCPHeader::to_string() const {
        << "TCP seqno: " << seqno << '\n'
        << "TCP ackno: " << ackno << '\n'
        << "TCP doff: " << +doff << '\n'
-       << "Flags: urg: " << urg << " ack: " << ack << " psh: " << psh << " rst: " << rst << " syn: " << syn
-       << " fin: " << fin << '\n'
+       << "Flags: cwr: " << cwr << " ece: " << ece << " urg: " << urg << " ack: " << ack << " psh: " << psh
+       << " rst: " << rst << " syn: " << syn << " fin: " << fin << '\n'
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
-       << "TCP uptr: " << +uptr << '\n';
+       << "TCP uptr: " << +uptr << '\n'
+       << "TCP options: " << options.to_string() << '\n';
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << (ece ? "E" : "") << (cwr ? "W" : "") << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
     return ss.str();
 }
 
 bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
-    return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
-           psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+    return seqno == other.seqno && ackno == other.ackno && doff == other.doff && cwr == other.cwr &&
+           ece == other.ece && urg == other.urg && ack == other.ack && psh == other.psh && rst == other.rst &&
+           syn == other.syn && fin == other.fin && win == other.win && uptr == other.uptr;
 }
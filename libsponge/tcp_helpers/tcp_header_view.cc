@@ -0,0 +1,70 @@
+#include "tcp_header_view.hh"
+
+#include "buffer.hh"
+#include "util.hh"
+
+#include <cstring>
+
+using namespace std;
+
+//! \param[in] segment the serialized segment, header first
+ParseResult TCPHeaderView::parse(const string_view segment) {
+    _data = nullptr;
+    _size = 0;
+    if (segment.size() < TCPHeader::LENGTH) {
+        return ParseResult::PacketTooShort;
+    }
+    const auto *data = reinterpret_cast<const uint8_t *>(segment.data());
+    const size_t header_length = 4 * static_cast<size_t>(data[12] >> 4);
+    if (header_length < TCPHeader::LENGTH) {
+        return ParseResult::HeaderTooShort;
+    }
+    if (header_length > segment.size()) {
+        return ParseResult::PacketTooShort;
+    }
+    _data = data;
+    _size = segment.size();
+    return ParseResult::NoError;
+}
+
+string_view TCPHeaderView::payload() const {
+    const size_t header_length = 4 * size_t{doff()};
+    return {reinterpret_cast<const char *>(_data) + header_length, _size - header_length};
+}
+
+//! \param[out] header the decoded header
+//! \details Copies the header's bytes (at most 60) for the NetParser; the payload is not touched.
+ParseResult TCPHeaderView::decode(TCPHeader &header) const {
+    NetParser p{string{header_bytes()}};
+    return header.parse(p);
+}
+
+//! \param[in,out] segment the serialized segment, header first, which setters will modify
+ParseResult MutableTCPHeaderView::parse(string &segment) {
+    const ParseResult ret = TCPHeaderView::parse(segment);
+    _mutable_data = ret == ParseResult::NoError ? reinterpret_cast<uint8_t *>(segment.data()) : nullptr;
+    return ret;
+}
+
+void MutableTCPHeaderView::store(const size_t offset, const uint8_t *bytes, const size_t len) {
+    const string old_bytes{reinterpret_cast<const char *>(_data) + offset, len};
+    memcpy(_mutable_data + offset, bytes, len);
+    const uint16_t sum = InternetChecksum::update(cksum(), old_bytes, {reinterpret_cast<const char *>(bytes), len});
+    _mutable_data[16] = sum >> 8;
+    _mutable_data[17] = sum & 0xff;
+}
+
+void MutableTCPHeaderView::set_seqno(const WrappingInt32 seqno) {
+    const uint32_t val = htobe32(seqno.raw_value());
+    store(4, reinterpret_cast<const uint8_t *>(&val), sizeof(val));
+}
+
+void MutableTCPHeaderView::set_ackno(const WrappingInt32 ackno) {
+    const uint32_t val = htobe32(ackno.raw_value());
+    store(8, reinterpret_cast<const uint8_t *>(&val), sizeof(val));
+}
+
+void MutableTCPHeaderView::set_win(const uint16_t win) {
+    const uint16_t val = htobe16(win);
+    store(14, reinterpret_cast<const uint8_t *>(&val), sizeof(val));
+}
@@ -0,0 +1,89 @@
+#ifndef SPONGE_LIBSPONGE_TCP_HEADER_VIEW_HH
+#define SPONGE_LIBSPONGE_TCP_HEADER_VIEW_HH
+
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "wrapping_integers.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+//! \brief A read-only view of a serialized [TCP](\ref rfc::rfc793) segment that decodes header fields on demand
+//!
+//! Demultiplexing by port, turning away a non-SYN sent to a listener or spotting a duplicate need a few
+//! fields, not a whole TCPHeader (and its options). parse() only checks that the header is all there;
+//! each accessor then loads its field straight from the bytes. Decode the header, or parse a TCPSegment
+//! from the same bytes, only once the segment is known to be wanted.
+//!
+//! The view does not own the bytes, which must outlive it.
+class TCPHeaderView {
+  protected:
+    const uint8_t *_data{nullptr};  //!< first byte of the header
+    size_t _size{0};                //!< bytes in the segment (header and payload)
+
+    uint8_t flags() const { return _data[13]; }
+
+  public:
+    //! \brief Point the view at a segment, checking that it holds a complete header
+    //! \returns PacketTooShort or HeaderTooShort (as TCPHeader::parse() would), or NoError
+    ParseResult parse(const std::string_view segment);
+
+    //! \name Header fields, in host byte order
+    //!@{
+    uint16_t sport() const { return NetParser::load_u16(_data); }
+    uint16_t dport() const { return NetParser::load_u16(_data + 2); }
+    WrappingInt32 seqno() const { return WrappingInt32{NetParser::load_u32(_data + 4)}; }
+    WrappingInt32 ackno() const { return WrappingInt32{NetParser::load_u32(_data + 8)}; }
+    uint8_t doff() const { return _data[12] >> 4; }
+    bool cwr() const { return flags() & 0b1000'0000; }
+    bool ece() const { return flags() & 0b0100'0000; }
+    bool urg() const { return flags() & 0b0010'0000; }
+    bool ack() const { return flags() & 0b0001'0000; }
+    bool psh() const { return flags() & 0b0000'1000; }
+    bool rst() const { return flags() & 0b0000'0100; }
+    bool syn() const { return flags() & 0b0000'0010; }
+    bool fin() const { return flags() & 0b0000'0001; }
+    uint16_t win() const { return NetParser::load_u16(_data + 14); }
+    uint16_t cksum() const { return NetParser::load_u16(_data + 16); }
+    uint16_t uptr() const { return NetParser::load_u16(_data + 18); }
+    //!@}
+
+    //! \brief The header, including its options
+    std::string_view header_bytes() const { return {reinterpret_cast<const char *>(_data), 4 * size_t{doff()}}; }
+
+    //! \brief The bytes after the header
+    std::string_view payload() const;
+
+    //! \brief Segment's length in sequence space (see TCPSegment::length_in_sequence_space())
+    size_t length_in_sequence_space() const { return payload().size() + syn() + fin(); }
+
+    //! \brief Decode the whole header, options included
+    ParseResult decode(TCPHeader &header) const;
+};
+
+//! \brief A TCPHeaderView that can also change fields in place, keeping the checksum correct
+//! \details Each setter adjusts the checksum incrementally for the bytes it changes
+//! ([RFC 1624](\ref rfc::rfc1624)), so that forwarding a segment with a new ackno or window costs
+//! a few additions instead of a pass over the payload.
+class MutableTCPHeaderView : public TCPHeaderView {
+  private:
+    uint8_t *_mutable_data{nullptr};
+
+    //! Overwrite `len` bytes at `offset` (which must be even) and fix up the checksum
+    void store(const size_t offset, const uint8_t *bytes, const size_t len);
+
+  public:
+    //! \brief Point the view at a segment held in `segment`, checking that it holds a complete header
+    ParseResult parse(std::string &segment);
+
+    //! \name Setters
+    //!@{
+    void set_seqno(const WrappingInt32 seqno);
+    void set_ackno(const WrappingInt32 ackno);
+    void set_win(const uint16_t win);
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_HEADER_VIEW_HH
@@ -0,0 +1,103 @@
+#include "tcp_isn.hh"
+
+#include "clock.hh"
+#include "util.hh"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+//! The 128-bit SipHash key, read from the kernel the first time an ISN is needed
+const array<uint64_t, 2> &secret_key() {
+    static const array<uint64_t, 2> key = [] {
+        array<uint64_t, 2> k{};
+        get_random_bytes(k.data(), sizeof(k));
+        return k;
+    }();
+    return key;
+}
+
+//! RFC 6528's M: a timer that ticks every 4 microseconds
+uint32_t isn_clock() { return static_cast<uint32_t>(Clock::now_ns() / 4000); }
+
+uint64_t rotl(const uint64_t x, const int b) { return (x << b) | (x >> (64 - b)); }
+
+//! One SipRound
+void sipround(array<uint64_t, 4> &v) {
+    v[0] += v[1];
+    v[1] = rotl(v[1], 13);
+    v[1] ^= v[0];
+    v[0] = rotl(v[0], 32);
+    v[2] += v[3];
+    v[3] = rotl(v[3], 16);
+    v[3] ^= v[2];
+    v[0] += v[3];
+    v[3] = rotl(v[3], 21);
+    v[3] ^= v[0];
+    v[2] += v[1];
+    v[1] = rotl(v[1], 17);
+    v[1] ^= v[2];
+    v[2] = rotl(v[2], 32);
+}
+
+}  // namespace
+
+//! \param[in] key the key, as two little-endian words
+//! \param[in] data the message
+//! \param[in] len its length in bytes
+//! \details Follows the reference implementation of SipHash-2-4, reading the message as little-endian words.
+uint64_t ISNGenerator::siphash24(const array<uint64_t, 2> &key, const void *data, const size_t len) {
+    array<uint64_t, 4> v{key[0] ^ 0x736f6d6570736575ULL,
+                         key[1] ^ 0x646f72616e646f6dULL,
+                         key[0] ^ 0x6c7967656e657261ULL,
+                         key[1] ^ 0x7465646279746573ULL};
+    const auto *in = static_cast<const uint8_t *>(data);
+
+    const auto compress = [&v](const uint64_t m) {
+        v[3] ^= m;
+        sipround(v);
+        sipround(v);
+        v[0] ^= m;
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t m = 0;
+        for (size_t j = 0; j < 8; j++) {
+            m |= uint64_t{in[i + j]} << (8 * j);
+        }
+        compress(m);
+    }
+    uint64_t last = uint64_t{len & 0xff} << 56;
+    for (size_t j = 0; i + j < len; j++) {
+        last |= uint64_t{in[i + j]} << (8 * j);
+    }
+    compress(last);
+
+    v[2] ^= 0xff;
+    for (unsigned round = 0; round < 4; round++) {
+        sipround(v);
+    }
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+//! \param[in] local our address and port
+//! \param[in] remote the peer's address and port
+WrappingInt32 ISNGenerator::isn(const Address &local, const Address &remote) {
+    array<uint8_t, 2 * sizeof(sockaddr_storage)> tuple{};
+    memcpy(tuple.data(), static_cast<const sockaddr *>(local), local.size());
+    memcpy(tuple.data() + local.size(), static_cast<const sockaddr *>(remote), remote.size());
+    const uint64_t f = siphash24(secret_key(), tuple.data(), local.size() + remote.size());
+    return WrappingInt32{isn_clock() + static_cast<uint32_t>(f)};
+}
+
+WrappingInt32 ISNGenerator::isn() {
+    static atomic<uint64_t> connections{0};
+    const uint64_t n = connections.fetch_add(1, memory_order_relaxed);
+    const uint64_t f = siphash24(secret_key(), &n, sizeof(n));
+    return WrappingInt32{isn_clock() + static_cast<uint32_t>(f)};
+}
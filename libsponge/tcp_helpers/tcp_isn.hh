@@ -0,0 +1,33 @@
+#ifndef SPONGE_LIBSPONGE_TCP_ISN_HH
+#define SPONGE_LIBSPONGE_TCP_ISN_HH
+
+#include "address.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//! \brief Initial Sequence Number selection as in [RFC 6528](\ref rfc::rfc6528)
+//!
+//! ISN = M + F(localip, localport, remoteip, remoteport, secretkey), where M is a clock that ticks
+//! every 4 microseconds and F is SipHash-2-4 of the connection's 4-tuple under a 128-bit key read
+//! once per process with get_random_bytes(). Successive connections between the same endpoints get
+//! increasing ISNs, while an off-path attacker cannot predict the ISN of anyone else's connection.
+//!
+//! Computing an ISN costs one clock read and one short hash, instead of a read from the kernel's
+//! random number generator per connection.
+class ISNGenerator {
+  public:
+    //! \brief SipHash-2-4 of `len` bytes at `data` under `key`
+    static uint64_t siphash24(const std::array<uint64_t, 2> &key, const void *data, const size_t len);
+
+    //! \brief The ISN for a connection between `local` and `remote`
+    static WrappingInt32 isn(const Address &local, const Address &remote);
+
+    //! \brief An ISN for a connection whose endpoints are not known (yet)
+    //! \details F is applied to a per-process connection counter instead of the 4-tuple.
+    static WrappingInt32 isn();
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_ISN_HH
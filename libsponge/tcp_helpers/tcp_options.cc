@@ -0,0 +1,296 @@
+#include "tcp_options.hh"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+//! Sequential writer over the fixed-size option space; drops anything that would not fit
+class OptionWriter {
+  private:
+    array<uint8_t, TCPOptions::MAX_LENGTH> &_out;
+    size_t _len = 0;
+
+  public:
+    explicit OptionWriter(array<uint8_t, TCPOptions::MAX_LENGTH> &out) : _out(out) {}
+
+    size_t length() const { return _len; }
+    size_t room() const { return TCPOptions::MAX_LENGTH - _len; }
+
+    void u8(const uint8_t val) { _out[_len++] = val; }
+    void u16(const uint16_t val) {
+        u8(val >> 8);
+        u8(val & 0xff);
+    }
+    void u32(const uint32_t val) {
+        u16(val >> 16);
+        u16(val & 0xffff);
+    }
+
+    //! Pad with NOPs so that an option of `len` bytes ends on a four-byte boundary
+    void align_for(const size_t len) {
+        while ((_len + len) % 4 != 0 && room() > len) {
+            u8(TCPOptions::KIND_NOP);
+        }
+    }
+};
+
+constexpr size_t MSS_LEN = 4;
+constexpr size_t WSCALE_LEN = 3;
+constexpr size_t SACK_PERMITTED_LEN = 2;
+constexpr size_t TIMESTAMPS_LEN = 10;
+
+size_t sack_len(const size_t blocks) { return 2 + 8 * blocks; }
+
+}  // namespace
+
+//! \param[in,out] p is a NetParser positioned at the first byte of the options
+//! \param[in] len is the number of bytes of options (i.e., `doff * 4 - TCPHeader::LENGTH`)
+//! \returns a ParseResult indicating success or the reason for failure
+//! \details Unrecognized options are skipped (but counted); an option whose length
+//!          field is malformed or runs past the end of the header is an error.
+ParseResult TCPOptions::parse(NetParser &p, const size_t len) {
+    *this = TCPOptions{};
+
+    if (len > MAX_LENGTH || len > p.buffer().size()) {
+        p.set_error(ParseResult::PacketTooShort);
+        return p.get_error();
+    }
+
+    // hold a reference: if the options end the packet, removing them can free the parser's storage
+    const Buffer header = p.buffer();
+    const string_view opts = header.str().substr(0, len);
+    p.remove_prefix(len);
+
+    const auto *raw = reinterpret_cast<const uint8_t *>(opts.data());
+    const auto octet = [&](const size_t i) { return raw[i]; };
+    const auto be16 = [&](const size_t i) { return NetParser::load_u16(raw + i); };
+    const auto be32 = [&](const size_t i) { return NetParser::load_u32(raw + i); };
+
+    size_t i = 0;
+    while (i < opts.size()) {
+        const uint8_t kind = octet(i);
+        _order[_order_len++] = kind;
+
+        if (kind == KIND_EOL) {
+            break;
+        }
+        if (kind == KIND_NOP) {
+            i++;
+            continue;
+        }
+
+        if (i + 1 >= opts.size() || octet(i + 1) < 2 || i + octet(i + 1) > opts.size()) {
+            return ParseResult::TruncatedPacket;
+        }
+        const size_t optlen = octet(i + 1);
+
+        switch (kind) {
+            case KIND_MSS:
+                if (optlen != MSS_LEN) {
+                    return ParseResult::TruncatedPacket;
+                }
+                mss = be16(i + 2);
+                break;
+            case KIND_WSCALE:
+                if (optlen != WSCALE_LEN) {
+                    return ParseResult::TruncatedPacket;
+                }
+                wscale = octet(i + 2);
+                break;
+            case KIND_SACK_PERMITTED:
+                if (optlen != SACK_PERMITTED_LEN) {
+                    return ParseResult::TruncatedPacket;
+                }
+                sack_permitted = true;
+                break;
+            case KIND_SACK:
+                if ((optlen - 2) % 8 != 0 || optlen == 2) {
+                    return ParseResult::TruncatedPacket;
+                }
+                num_sack_blocks = (optlen - 2) / 8;
+                for (size_t b = 0; b < num_sack_blocks; b++) {
+                    sack_blocks[b].left = WrappingInt32{be32(i + 2 + 8 * b)};
+                    sack_blocks[b].right = WrappingInt32{be32(i + 6 + 8 * b)};
+                }
+                break;
+            case KIND_TIMESTAMPS:
+                if (optlen != TIMESTAMPS_LEN) {
+                    return ParseResult::TruncatedPacket;
+                }
+                ts = Timestamps{be32(i + 2), be32(i + 6)};
+                break;
+            default:
+                _unknown++;
+                _order_len--;
+                break;
+        }
+        i += optlen;
+    }
+
+    return p.get_error();
+}
+
+size_t TCPOptions::_write(array<uint8_t, MAX_LENGTH> &out) const {
+    OptionWriter w{out};
+
+    // which options have yet to be written
+    bool need_mss = mss.has_value();
+    bool need_wscale = wscale.has_value();
+    bool need_sack_permitted = sack_permitted;
+    bool need_sack = num_sack_blocks > 0;
+    bool need_ts = ts.has_value();
+
+    const auto write_option = [&](const uint8_t kind) {
+        switch (kind) {
+            case KIND_MSS:
+                if (need_mss && w.room() >= MSS_LEN) {
+                    w.u8(KIND_MSS);
+                    w.u8(MSS_LEN);
+                    w.u16(mss.value());
+                }
+                need_mss = false;
+                break;
+            case KIND_WSCALE:
+                if (need_wscale && w.room() >= WSCALE_LEN) {
+                    w.u8(KIND_WSCALE);
+                    w.u8(WSCALE_LEN);
+                    w.u8(wscale.value());
+                }
+                need_wscale = false;
+                break;
+            case KIND_SACK_PERMITTED:
+                if (need_sack_permitted && w.room() >= SACK_PERMITTED_LEN) {
+                    w.u8(KIND_SACK_PERMITTED);
+                    w.u8(SACK_PERMITTED_LEN);
+                }
+                need_sack_permitted = false;
+                break;
+            case KIND_SACK:
+                if (need_sack && w.room() >= sack_len(1)) {
+                    const size_t blocks = min<size_t>(num_sack_blocks, (w.room() - 2) / 8);
+                    w.u8(KIND_SACK);
+                    w.u8(sack_len(blocks));
+                    for (size_t b = 0; b < blocks; b++) {
+                        w.u32(sack_blocks[b].left.raw_value());
+                        w.u32(sack_blocks[b].right.raw_value());
+                    }
+                }
+                need_sack = false;
+                break;
+            case KIND_TIMESTAMPS:
+                if (need_ts && w.room() >= TIMESTAMPS_LEN) {
+                    w.u8(KIND_TIMESTAMPS);
+                    w.u8(TIMESTAMPS_LEN);
+                    w.u32(ts.value().val);
+                    w.u32(ts.value().ecr);
+                }
+                need_ts = false;
+                break;
+        }
+    };
+
+    // first, reproduce the layout that was parsed off the wire
+    bool eol = false;
+    for (size_t i = 0; i < _order_len && not eol; i++) {
+        switch (_order[i]) {
+            case KIND_NOP:
+                if (w.room()) {
+                    w.u8(KIND_NOP);
+                }
+                break;
+            case KIND_EOL:
+                eol = true;
+                break;
+            default:
+                write_option(_order[i]);
+        }
+    }
+
+    // then append anything that was added since, in the canonical (Linux-like) layout
+    if (need_mss) {
+        write_option(KIND_MSS);
+    }
+    if (need_sack_permitted && need_ts) {
+        write_option(KIND_SACK_PERMITTED);
+        write_option(KIND_TIMESTAMPS);
+    }
+    if (need_ts) {
+        w.align_for(TIMESTAMPS_LEN);
+        write_option(KIND_TIMESTAMPS);
+    }
+    if (need_sack_permitted) {
+        w.align_for(SACK_PERMITTED_LEN);
+        write_option(KIND_SACK_PERMITTED);
+    }
+    if (need_wscale) {
+        w.align_for(WSCALE_LEN);
+        write_option(KIND_WSCALE);
+    }
+    if (need_sack) {
+        w.align_for(2);
+        write_option(KIND_SACK);
+    }
+
+    if (eol && w.room()) {
+        w.u8(KIND_EOL);
+    }
+
+    // pad with EOL (zero) bytes to a four-byte boundary
+    while (w.length() % 4 != 0) {
+        w.u8(KIND_EOL);
+    }
+
+    return w.length();
+}
+
+void TCPOptions::serialize(string &s) const {
+    array<uint8_t, MAX_LENGTH> out{};
+    const size_t len = _write(out);
+    s.append(reinterpret_cast<const char *>(out.data()), len);
+}
+
+//! \param[out] out where to write the options
+//! \param[in] len room at `out`, in bytes
+size_t TCPOptions::serialize_into(uint8_t *out, const size_t len) const {
+    array<uint8_t, MAX_LENGTH> buf{};
+    const size_t written = _write(buf);
+    if (written > len) {
+        throw runtime_error("TCPOptions::serialize_into: not enough room");
+    }
+    memcpy(out, buf.data(), written);
+    return written;
+}
+
+size_t TCPOptions::length() const {
+    array<uint8_t, MAX_LENGTH> out{};
+    return _write(out);
+}
+
+//! \returns A string with the options' contents
+string TCPOptions::to_string() const {
+    stringstream ss{};
+    if (mss.has_value()) {
+        ss << "mss=" << mss.value() << ' ';
+    }
+    if (wscale.has_value()) {
+        ss << "wscale=" << +wscale.value() << ' ';
+    }
+    if (sack_permitted) {
+        ss << "sackOK ";
+    }
+    for (size_t b = 0; b < num_sack_blocks; b++) {
+        ss << "sack=[" << sack_blocks[b].left << ',' << sack_blocks[b].right << ") ";
+    }
+    if (ts.has_value()) {
+        ss << "ts=" << ts.value().val << " ecr=" << ts.value().ecr << ' ';
+    }
+    string ret = ss.str();
+    if (not ret.empty()) {
+        ret.pop_back();
+    }
+    return ret;
+}
@@ -0,0 +1,91 @@
+#ifndef SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+#define SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+
+#include "parser.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//! \brief The [TCP](\ref rfc::rfc793) options carried between the fixed header and the payload
+//!
+//! Every supported option is decoded into a fixed-size field, so parsing never allocates.
+//! The order in which options appeared on the wire (including NOP and EOL padding) is
+//! remembered, so that a parsed header re-serializes to the same bytes.
+struct TCPOptions {
+    static constexpr size_t MAX_LENGTH = 40;     //!< Options can occupy at most 40 bytes (doff == 15)
+    static constexpr size_t MAX_SACK_BLOCKS = 4;  //!< At most four SACK blocks fit in the option space
+
+    //! \name Option kinds
+    //!@{
+    static constexpr uint8_t KIND_EOL = 0;             //!< End of option list
+    static constexpr uint8_t KIND_NOP = 1;             //!< No-operation (padding)
+    static constexpr uint8_t KIND_MSS = 2;             //!< Maximum segment size ([RFC 793](\ref rfc::rfc793))
+    static constexpr uint8_t KIND_WSCALE = 3;          //!< Window scale ([RFC 7323](\ref rfc::rfc7323))
+    static constexpr uint8_t KIND_SACK_PERMITTED = 4;  //!< SACK permitted ([RFC 2018](\ref rfc::rfc2018))
+    static constexpr uint8_t KIND_SACK = 5;            //!< SACK blocks ([RFC 2018](\ref rfc::rfc2018))
+    static constexpr uint8_t KIND_TIMESTAMPS = 8;      //!< Timestamps ([RFC 7323](\ref rfc::rfc7323))
+    //!@}
+
+    //! A selectively-acknowledged range of sequence numbers, `[left, right)`
+    struct SACKBlock {
+        WrappingInt32 left{0};   //!< first sequence number of the block
+        WrappingInt32 right{0};  //!< sequence number just past the block
+    };
+
+    //! The two values of the timestamps option
+    struct Timestamps {
+        uint32_t val = 0;  //!< TSval: the sender's clock when the segment was sent
+        uint32_t ecr = 0;  //!< TSecr: the most recent TSval received from the peer
+    };
+
+    //! \name Option fields
+    //!@{
+    std::optional<uint16_t> mss{};                         //!< maximum segment size (SYN only)
+    std::optional<uint8_t> wscale{};                       //!< window scale shift count (SYN only)
+    bool sack_permitted = false;                           //!< SACK permitted (SYN only)
+    std::array<SACKBlock, MAX_SACK_BLOCKS> sack_blocks{};  //!< SACK blocks, first `num_sack_blocks` are valid
+    uint8_t num_sack_blocks = 0;                           //!< number of valid SACK blocks
+    std::optional<Timestamps> ts{};                        //!< timestamps
+    //!@}
+
+  private:
+    std::array<uint8_t, MAX_LENGTH> _order{};  //!< option kinds in the order they were parsed
+    uint8_t _order_len = 0;                    //!< number of valid entries in `_order`
+    uint8_t _unknown = 0;                      //!< number of unrecognized options skipped while parsing
+
+    //! Encode the options into `out`, returning the padded length
+    size_t _write(std::array<uint8_t, MAX_LENGTH> &out) const;
+
+  public:
+    //! Parse `len` bytes of options from the provided NetParser
+    ParseResult parse(NetParser &p, const size_t len);
+
+    //! Append the options, padded to a multiple of four bytes, to `s`
+    void serialize(std::string &s) const;
+
+    //! \brief Write the options, padded to a multiple of four bytes, to `out` (MAX_LENGTH bytes of room suffice)
+    //! \returns their length
+    size_t serialize_into(uint8_t *out, const size_t len) const;
+
+    //! Length of the serialized options, including padding (always a multiple of four)
+    size_t length() const;
+
+    //! `true` if no options are present
+    bool empty() const { return length() == 0; }
+
+    //! Number of unrecognized options that were skipped by parse()
+    size_t unknown_options() const { return _unknown; }
+
+    //! Forget the wire order recorded by parse(), so that serialize() emits the canonical layout
+    void reset_layout() { _order_len = 0; }
+
+    //! Return a string containing the options in human-readable format
+    std::string to_string() const;
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_OPTIONS_HH
@@ -1,44 +1,131 @@
 #include "tcp_segment.hh"
 
+#include "checksum.hh"
 #include "parser.hh"
 #include "util.hh"
 
+#include <array>
+#include <cstring>
+#include <string>
 #include <variant>
 
 using namespace std;
 
 //! \param[in] buffer string/Buffer to be parsed
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
-ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer_checksum) {
+//! \param[in] defer_payload_checksum leave the payload's part of the checksum to be verified when it is copied
+ParseResult TCPSegment::parse(const Buffer buffer,
+                              const uint32_t datagram_layer_checksum,
+                              const bool defer_payload_checksum) {
+    _expected_payload_sum.reset();
+    if (not defer_payload_checksum) {
+        InternetChecksum check(datagram_layer_checksum);
+        check.add(buffer);
+        if (check.value()) {
+            return ParseResult::BadChecksum;
+        }
+    }
+
+    NetParser p{buffer};
+    _header.parse(p);
+    _payload = p.buffer();
+    if (p.error() || not defer_payload_checksum) {
+        return p.get_error();
+    }
+
+    // the header is a whole number of 32-bit words, so the payload begins a 16-bit word
     InternetChecksum check(datagram_layer_checksum);
-    check.add(buffer);
-    if (check.value()) {
-        return ParseResult::BadChecksum;
+    check.add(buffer.str().substr(0, buffer.size() - _payload.size()));
+    if (_payload.size() == 0) {
+        return check.value() ? ParseResult::BadChecksum : ParseResult::NoError;
     }
+    _expected_payload_sum = check.value();  // the payload's sum must bring the total to 0xffff
+    return ParseResult::NoError;
+}
 
+//! \param[in] buffer string/Buffer to be parsed
+ParseResult TCPSegment::parse_unverified(const Buffer buffer) {
+    _expected_payload_sum.reset();
     NetParser p{buffer};
     _header.parse(p);
     _payload = p.buffer();
     return p.get_error();
 }
 
+//! \details The cache holds a reference to the payload it was computed for, whose storage is immutable;
+//! while it does, no other payload can occupy the same bytes.
+uint16_t TCPSegment::payload_sum() const {
+    const string_view payload = _payload.str();
+    const string_view summed = _summed_payload.str();
+    if (payload.data() != summed.data() || payload.size() != summed.size()) {
+        _payload_sum = ChecksumKernel::sum(reinterpret_cast<const uint8_t *>(payload.data()), payload.size());
+        _summed_payload = _payload;
+    }
+    return _payload_sum;
+}
+
+//! \param[in] payload the new payload
+//! \param[in] sum its one's-complement sum, e.g. from ChecksumKernel::copy_and_sum()
+void TCPSegment::set_payload(Buffer payload, const uint16_t sum) {
+    _payload = std::move(payload);
+    _summed_payload = _payload;
+    _payload_sum = sum;
+    _expected_payload_sum.reset();
+}
+
+bool TCPSegment::payload_valid() const {
+    return payload_verified() || ChecksumKernel::equal(payload_sum(), _expected_payload_sum.value());
+}
+
 size_t TCPSegment::length_in_sequence_space() const {
     return payload().str().size() + (header().syn ? 1 : 0) + (header().fin ? 1 : 0);
 }
 
+//! \param[out] out where to write the header
+//! \param[in] len room at `out`, in bytes
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
-BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
-    TCPHeader header_out = _header;
-    header_out.cksum = 0;
+size_t TCPSegment::serialize_header_into(uint8_t *out, const size_t len, const uint32_t datagram_layer_checksum) const {
+    const size_t header_length = _header.serialize_into(out, len);
 
-    // calculate checksum -- taken over entire segment
+    // calculate checksum -- taken over entire segment (with the checksum field zeroed), payload's sum cached
+    out[16] = out[17] = 0;
     InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
-    header_out.cksum = check.value();
+    check.add({reinterpret_cast<const char *>(out), header_length});
+    check.add_sum(payload_sum());
+    NetUnparser::store_u16(out + 16, check.value());
+
+    return header_length;
+}
+
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
+    array<uint8_t, TCPHeader::MAX_LENGTH> header;
+    const size_t header_length = serialize_header_into(header.data(), header.size(), datagram_layer_checksum);
+
+    BufferList ret{string{reinterpret_cast<const char *>(header.data()), header_length}};
+    ret.append(_payload);
+
+    return ret;
+}
+
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+//! \param[in] headroom bytes to leave free in front of the TCP header
+PacketBuffer TCPSegment::serialize_packet(const uint32_t datagram_layer_checksum, const size_t headroom) const {
+    array<uint8_t, TCPHeader::MAX_LENGTH> header;
+    const size_t header_length = serialize_header_into(header.data(), header.size(), datagram_layer_checksum);
+
+    PacketBuffer packet{_payload.str(), headroom + header_length};
+    memcpy(packet.prepend(header_length), header.data(), header_length);
+    return packet;
+}
+
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+BufferList TCPSegment::serialize_partial(const uint32_t datagram_layer_checksum) const {
+    array<uint8_t, TCPHeader::MAX_LENGTH> header;
+    const size_t header_length = _header.serialize_into(header.data(), header.size());
+    NetUnparser::store_u16(header.data() + 16, InternetChecksum(datagram_layer_checksum).sum());
 
-    BufferList ret;
-    ret.append(header_out.serialize());
+    BufferList ret{string{reinterpret_cast<const char *>(header.data()), header_length}};
     ret.append(_payload);
 
     return ret;
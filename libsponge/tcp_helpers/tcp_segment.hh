@@ -5,20 +5,49 @@
 #include "tcp_header.hh"
 
 #include <cstdint>
+#include <optional>
 
 //! \brief [TCP](\ref rfc::rfc793) segment
 class TCPSegment {
   private:
     TCPHeader _header{};
     Buffer _payload{};
+    mutable Buffer _summed_payload{};  //!< the payload that _payload_sum was computed for
+    mutable uint16_t _payload_sum{0};  //!< one's-complement sum of _summed_payload
+    std::optional<uint16_t> _expected_payload_sum{};  //!< payload sum that the checksum requires, if unverified
 
   public:
     //! \brief Parse the segment from a string
-    ParseResult parse(const Buffer buffer, const uint32_t datagram_layer_checksum = 0);
+    //! \details With `defer_payload_checksum`, only the header (and pseudo-header) is summed here: the
+    //! checksum is verified later, when the payload is copied (see TCPReceiver), or by payload_valid().
+    ParseResult parse(const Buffer buffer,
+                      const uint32_t datagram_layer_checksum = 0,
+                      const bool defer_payload_checksum = false);
+
+    //! \brief Parse the segment from a string without checking its checksum
+    //! \note Only for segments that the device or peer has already checked (see ChecksumPolicy)
+    ParseResult parse_unverified(const Buffer buffer);
 
     //! \brief Serialize the segment to a string
     BufferList serialize(const uint32_t datagram_layer_checksum = 0) const;
 
+    //! \brief Write the header, with its checksum, into `len` bytes of storage at `out`; the payload follows it
+    //! \returns the header's length
+    //! \details Allocates nothing: the header is written once and its checksum patched in place, with the
+    //! payload's sum from payload_sum(). TCPHeader::MAX_LENGTH bytes of storage always suffice.
+    size_t serialize_header_into(uint8_t *out, const size_t len, const uint32_t datagram_layer_checksum = 0) const;
+
+    //! \brief Serialize the segment into one contiguous PacketBuffer, leaving `headroom` bytes in front
+    //! \details The payload is copied once, and the header written straight in front of it; the network
+    //! and link layers can then prepend theirs in place.
+    PacketBuffer serialize_packet(const uint32_t datagram_layer_checksum = 0,
+                                  const size_t headroom = PacketBuffer::DEFAULT_HEADROOM) const;
+
+    //! \brief Serialize the segment with only the pseudo-header's sum in the checksum field
+    //! \details For partial checksum offload: the device completes the checksum by summing the segment
+    //! (starting at its first byte) and storing the complement in the checksum field.
+    BufferList serialize_partial(const uint32_t datagram_layer_checksum) const;
+
     //! \name Accessors
     //!@{
     const TCPHeader &header() const { return _header; }
@@ -28,6 +57,27 @@ class TCPSegment {
     Buffer &payload() { return _payload; }
     //!@}
 
+    //! \brief One's-complement sum of the payload, as for InternetChecksum::add_sum()
+    //! \details Computed once and cached (in copies of the segment, too) until the payload is replaced,
+    //! so that serializing a retransmission only sums the header.
+    uint16_t payload_sum() const;
+
+    //! \brief Replace the payload with one whose sum (see payload_sum()) is already known
+    void set_payload(Buffer payload, const uint16_t sum);
+
+    //! \name Deferred checksum verification
+    //!@{
+
+    //! \brief Has the checksum been verified (or was there nothing to verify)?
+    bool payload_verified() const { return not _expected_payload_sum.has_value(); }
+
+    //! \brief The payload_sum() that the segment's checksum requires, if not verified yet
+    std::optional<uint16_t> expected_payload_sum() const { return _expected_payload_sum; }
+
+    //! \brief Is the checksum correct? (Sums the payload, unless it is already verified.)
+    bool payload_valid() const;
+    //!@}
+
     //! \brief Segment's length in sequence space
     //! \note Equal to payload length plus one byte if SYN is set, plus one byte if FIN is set
     size_t length_in_sequence_space() const;
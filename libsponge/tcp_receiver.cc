@@ -2,28 +2,354 @@
 
 using namespace std;
 
-void TCPReceiver::segment_received(const TCPSegment &seg) {
-    bool syn = seg.header().syn;
-    bool fin = seg.header().fin;
+//! \param[in] cfg the receive capacity, timestamps, delayed-ACK, auto-tuning, SWS and ECN settings to use
+TCPReceiver::TCPReceiver(const TCPConfig &cfg) : TCPReceiver(cfg.recv_capacity) {
+    _timestamps_offered = cfg.timestamps;
+    _delack_timeout = cfg.delack_timeout;
+    _quickack = cfg.quickack;
+    _capacity_max = max(cfg.recv_capacity, cfg.recv_capacity_max);
+    _rtt_estimate = max<size_t>(cfg.rt_timeout, 1);
+    _sws_avoidance = cfg.sws_avoidance;
+    _mss = cfg.mss;
+    _ecn_offered = cfg.ecn;
+    _dctcp = cfg.ecn && cfg.dctcp;
+}
+
+//! \details Implements the PAWS test of [RFC 7323](\ref rfc::rfc7323), section 5.3. Once timestamps
+//! are in use, a segment whose TSval is older than TS.Recent is a duplicate from an earlier trip
+//! around the sequence space (even if its seqno looks acceptable), and so is a segment without
+//! a timestamp. RST segments are exempt. TS.Recent itself is updated from segments that cover
+//! the left edge of the window.
+bool TCPReceiver::paws_reject(const TCPHeader &hdr) {
+    const auto &ts = hdr.options.ts;
+    if (not _timestamps || hdr.rst) {
+        return false;
+    }
+
+    if (not ts.has_value() ||
+        (_ts_recent.has_value() && static_cast<int32_t>(ts.value().val - _ts_recent.value()) < 0)) {
+        _paws_rejected++;
+        return true;
+    }
+
+    // SEG.SEQ <= Last.ACK.sent: the segment starts at (or before) the ackno we have advertised
+    const uint64_t left_edge = _reassembler.stream_out().bytes_written() + 1;
+    if (unwrap(hdr.seqno, _isn, _seq) <= left_edge) {
+        _ts_recent = ts.value().val;
+    }
+    return false;
+}
+
+//! \details A segment parsed with its checksum left unverified is verified as its payload is copied into
+//!          the stream if it is predicted(), and before anything else is done with it otherwise.
+void TCPReceiver::segment_received(const TCPSegment &seg, const bool ce) {
+    const SegmentCount count{1, seg.payload().size()};
+    if (seg.payload_verified()) {
+        receive(seg.header(), seg.payload(), count, ce);
+        return;
+    }
+
+    if (not predicted(seg.header(), seg.payload().size())) {
+        if (not seg.payload_valid()) {
+            _bad_checksums++;
+            return;
+        }
+        receive(seg.header(), seg.payload(), count, ce);
+        return;
+    }
+
+    // a predicted segment is not trimmed, so its whole payload is copied (and summed) in one piece;
+    // the only state touched before that is TS.Recent
+    const optional<uint32_t> ts_recent = _ts_recent;
+    if (not receive(seg.header(), seg.payload(), count, ce, seg.expected_payload_sum())) {
+        _ts_recent = ts_recent;
+        _bad_checksums++;
+    }
+}
+
+bool TCPReceiver::predicted(const TCPHeader &hdr, const size_t payload_size) const {
+    if (not _syn_received || hdr.syn || hdr.fin || hdr.rst || payload_size == 0 || unassembled_bytes() > 0) {
+        return false;
+    }
+    if (unwrap(hdr.seqno, _isn, _seq) != stream_out().bytes_written() + 1 || payload_size > window_size()) {
+        return false;
+    }
+    if (_timestamps) {
+        // what paws_reject() would reject
+        const auto &ts = hdr.options.ts;
+        if (not ts.has_value() ||
+            (_ts_recent.has_value() && static_cast<int32_t>(ts.value().val - _ts_recent.value()) < 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! \details The run is handled like one large segment: one unwrap, one window check and
+//!          one copy of the accepted bytes.
+void TCPReceiver::segment_received(const TCPSegmentRun &run, const bool ce) {
+    receive(run.header, run.payload, {run.segments, run.segment_size}, ce);
+}
+
+//! \param[in] hdr the header of the segment (or of the first segment of a run)
+//! \param[in] payload the payload
+//! \param[in] count the number and size of the segments whose payloads make up `payload`
+//! \param[in] ce whether it arrived marked Congestion Experienced
+//! \param[in] sum the sum the payload must have, if it is to be verified as it is copied (only given
+//!                for predicted() segments, which are pushed whole)
+//! \details Bytes that fall outside the window are trimmed off a (reference-counted) copy of the
+//!          payload before the rest is passed to the reassembler, so that they are never copied.
+template <typename Payload>
+bool TCPReceiver::receive(const TCPHeader &hdr,
+                          const Payload &payload,
+                          const SegmentCount count,
+                          const bool ce,
+                          const optional<uint16_t> sum) {
+    bool syn = hdr.syn;
+    bool fin = hdr.fin;
 
     if (syn) {
         // first sequential number received
-        _isn = seg.header().seqno;
+        _isn = hdr.seqno;
         _syn_received = true;
         _fin_received = false;
+
+        // timestamps are in use if both SYNs carry them
+        _timestamps = _timestamps_offered && hdr.options.ts.has_value();
+        _ts_recent.reset();
+        if (_timestamps) {
+            _ts_recent = hdr.options.ts.value().val;
+        }
+
+        // the peer agrees to ECN with ECE and CWR on its SYN, or with ECE alone on its SYN-ACK
+        _ecn = _ecn_offered && hdr.ece && (hdr.ack ? not hdr.cwr : hdr.cwr);
+        _ece = false;
+    } else if (paws_reject(hdr)) {
+        // an old duplicate still gets an ACK, so that the peer resynchronizes
+        _ack_due = true;
+        return true;
     }
-    if (fin) {
-        _fin_received = true;
-    }
 
-    string payload = seg.payload().copy();
-    uint64_t index = unwrap(seg.header().seqno, _isn, _seq);
+    // data received earlier but not yet acknowledged (for DCTCP, which must ACK it before changing ECE)
+    const bool unacked = not syn && (_ack_due || _delack.has_value());
+    const optional<WrappingInt32> unacked_ackno = unacked ? ackno() : nullopt;
+
+    const uint64_t expected_seq = _reassembler.stream_out().bytes_written() + (_syn_received && !syn);
+    const bool had_holes = unassembled_bytes() > 0;
+
+    const size_t payload_size = payload.size();
+    uint64_t index = unwrap(hdr.seqno, _isn, _seq);
 
     if (_syn_received) {
-        _reassembler.push_substring(payload, index - (!syn), fin);
+        // absolute seqno of the first payload byte; the SYN's own seqno cannot carry data or a FIN
+        uint64_t first = index + syn;
+        size_t prefix = 0;
+        if (first == 0) {
+            prefix = min<size_t>(payload_size, 1);
+            fin = fin && payload_size > 0;
+            first = 1;
+        }
+
+        // trim to the window: bytes already reassembled, and bytes beyond the right edge
+        uint64_t stream_index = first - 1 + prefix;
+        const uint64_t left_edge = stream_out().bytes_written();
+        const uint64_t right_edge = left_edge + window_size();
+        if (stream_index < left_edge) {
+            const size_t n = min<uint64_t>(payload_size - prefix, left_edge - stream_index);
+            prefix += n;
+            stream_index += n;
+        }
+        size_t suffix = 0;
+        if (stream_index + (payload_size - prefix) > right_edge) {
+            suffix = min<uint64_t>(payload_size - prefix, stream_index + (payload_size - prefix) - right_edge);
+            fin = false;
+        }
+
+        if (prefix == 0 && suffix == 0) {
+            if (not push_payload(payload, stream_index, fin, sum)) {
+                return false;
+            }
+        } else {
+            Payload trimmed = payload;
+            trimmed.remove_prefix(prefix);
+            trimmed.remove_suffix(suffix);
+            push_payload(trimmed, stream_index, fin, nullopt);
+        }
+        if (fin) {
+            _fin_received = true;
+        }
     }
 
     _seq = index;
+
+    update_ack_state(hdr, payload_size, count, expected_seq, had_holes);
+    if (_ecn && _syn_received) {
+        update_ecn_state(hdr, ce, unacked_ackno);
+    }
+    return true;
+}
+
+//! \param[in] hdr the header of the segment just received
+//! \param[in] ce whether it arrived marked Congestion Experienced
+//! \param[in] unacked_ackno the ackno before it, if data received before it is still unacknowledged
+void TCPReceiver::update_ecn_state(const TCPHeader &hdr, const bool ce, const optional<WrappingInt32> unacked_ackno) {
+    _ce_marks += ce;
+    if (_dctcp) {
+        if (ce != _ece) {
+            // the earlier data is acknowledged with the old ECE first (RFC 8257, 3.2)
+            if (unacked_ackno.has_value()) {
+                _ce_transition_ack = EcnAck{unacked_ackno.value(), _ece};
+            }
+            _ece = ce;
+            _ack_due = true;
+        }
+        return;
+    }
+
+    // keep echoing until the sender says it has reacted (RFC 3168, 6.1.3)
+    if (hdr.cwr) {
+        _ece = false;
+    }
+    if (ce) {
+        _ece = true;
+        _ack_due = true;
+    }
+}
+
+//! \param[in] payload the payload (or what is left of it) of a segment
+//! \param[in] index the stream index of its first byte
+//! \param[in] fin whether the stream ends with it
+//! \param[in] sum the sum it must have, if it is to be verified as it is copied
+//! \returns `false` if it was not pushed because its sum was wrong
+bool TCPReceiver::push_payload(const Buffer &payload,
+                               const uint64_t index,
+                               const bool fin,
+                               const optional<uint16_t> sum) {
+    if (sum.has_value()) {
+        return _reassembler.push_checked(payload.str(), index, fin, sum.value());
+    }
+    _reassembler.push_substring(payload.str(), index, fin);
+    return true;
+}
+
+//! \param[in] payload the chained payloads of a run of segments
+//! \param[in] index the stream index of its first byte
+//! \param[in] fin whether the stream ends with it
+//! \returns `true` (a run's checksums are verified when it is coalesced)
+bool TCPReceiver::push_payload(const BufferList &payload,
+                               const uint64_t index,
+                               const bool fin,
+                               const optional<uint16_t>) {
+    _reassembler.push_buffers(payload, index, fin);
+    return true;
+}
+
+//! \param[in] hdr the header of the segment just received
+//! \param[in] payload_size the size of its payload
+//! \param[in] count the number and size of the segments coalesced into it
+//! \param[in] expected_seq the absolute seqno the receiver was expecting before it arrived
+//! \param[in] had_holes whether out-of-order data was waiting before it arrived
+void TCPReceiver::update_ack_state(const TCPHeader &hdr,
+                                   const size_t payload_size,
+                                   const SegmentCount count,
+                                   const uint64_t expected_seq,
+                                   const bool had_holes) {
+    if (payload_size + hdr.syn + hdr.fin == 0 || not _syn_received) {
+        return;  // nothing to acknowledge
+    }
+    _ack_stats.segments += count.segments;
+    _rcv_mss = max(_rcv_mss, count.segment_size);
+
+    bool now = _delack_timeout == 0 || hdr.syn || hdr.fin || hdr.psh;
+
+    // out-of-order data, or data that fills (part of) a hole, is acknowledged immediately
+    now = now || unwrap(hdr.seqno, _isn, _seq) != expected_seq || had_holes || unassembled_bytes() > 0;
+
+    if (_quickack > 0 && not hdr.syn) {
+        _quickack--;
+        now = true;
+    }
+
+    // all but the last segment of a run are `segment_size` bytes; the last may be shorter
+    if (count.segment_size >= _rcv_mss) {
+        _full_sized_unacked += payload_size >= count.segments * _rcv_mss ? count.segments : count.segments - 1;
+    }
+    if (_full_sized_unacked >= 2) {
+        now = true;
+    }
+
+    if (now) {
+        _ack_stats.immediate_acks++;
+        _ack_due = true;
+    } else if (not _delack.has_value()) {
+        _delack = _delack_timeout;
+    }
+}
+
+void TCPReceiver::ack_sent() {
+    const ByteStream &stream = _reassembler.stream_out();
+    _advertised_edge = max(_advertised_edge, stream.bytes_written() + window_size());
+    _ack_stats.acks_sent += _ce_transition_ack.has_value() ? 2 : 1;
+    _ce_transition_ack.reset();
+    _ack_due = false;
+    _delack.reset();
+    _full_sized_unacked = 0;
+}
+
+//! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
+void TCPReceiver::tick(const size_t ms_since_last_tick) {
+    if (_capacity_max > _capacity_min && _syn_received) {
+        _autotune_elapsed += ms_since_last_tick;
+        if (_autotune_elapsed >= _rtt_estimate) {
+            autotune();
+        }
+    }
+
+    if (not _delack.has_value()) {
+        return;
+    }
+    if (ms_since_last_tick >= _delack.value()) {
+        _delack.reset();
+        if (not _ack_due) {
+            _ack_stats.delayed_acks++;
+            _ack_due = true;
+        }
+    } else {
+        _delack.value() -= ms_since_last_tick;
+    }
+}
+
+optional<size_t> TCPReceiver::next_timeout() const {
+    optional<size_t> next = _delack;
+    if (_capacity_max > _capacity_min && _syn_received) {
+        const size_t interval_end = _rtt_estimate > _autotune_elapsed ? _rtt_estimate - _autotune_elapsed : 0;
+        next = min(next.value_or(interval_end), interval_end);
+    }
+    return next;
+}
+
+void TCPReceiver::autotune() {
+    const ByteStream &stream = _reassembler.stream_out();
+    const uint64_t copied = stream.bytes_read() - _autotune_read_mark;
+    const uint64_t arrived = stream.bytes_written() - _autotune_written_mark;
+
+    size_t target = _capacity;
+    if (2 * copied > _capacity) {
+        target = min<uint64_t>(2 * copied, _capacity_max);
+    } else if (copied == 0 && arrived == 0) {
+        // idle: give memory back, but never retract the window already offered to the peer
+        const uint64_t promised = _advertised_edge > stream.bytes_read() ? _advertised_edge - stream.bytes_read() : 0;
+        target = max<uint64_t>({_capacity / 2, _capacity_min, promised});
+    }
+
+    if (target != _capacity) {
+        _reassembler.set_capacity(target);
+        _capacity = _reassembler.capacity();
+    }
+
+    _autotune_elapsed = 0;
+    _autotune_read_mark = stream.bytes_read();
+    _autotune_written_mark = stream.bytes_written();
 }
 
 optional<WrappingInt32> TCPReceiver::ackno() const {
@@ -41,5 +367,16 @@ optional<WrappingInt32> TCPReceiver::ackno() const {
 
 size_t TCPReceiver::window_size() const {
     size_t buffer_size = _reassembler.stream_out().buffer_size();
-    return _capacity - buffer_size;
+    const size_t window = _capacity - buffer_size;
+    if (not _sws_avoidance) {
+        return window;
+    }
+
+    // don't advance the right edge by a sliver; keep offering the edge already advertised
+    const uint64_t bytes_written = _reassembler.stream_out().bytes_written();
+    const uint64_t edge = bytes_written + window;
+    if (edge < _advertised_edge + min(_mss, _capacity / 2)) {
+        return _advertised_edge > bytes_written ? min<uint64_t>(window, _advertised_edge - bytes_written) : 0;
+    }
+    return window;
 }
@@ -3,9 +3,12 @@
 
 #include "byte_stream.hh"
 #include "stream_reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_gro.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <optional>
 
 //! \brief The "receiver" part of a TCP implementation.
@@ -14,6 +17,22 @@
 //! the acknowledgment number and window size to advertise back to the
 //! remote TCPSender.
 class TCPReceiver {
+  public:
+    //! Counters describing how inbound segments were acknowledged (see ack_stats())
+    struct AckStats {
+        size_t segments{0};        //!< segments received that occupy sequence space
+        size_t acks_sent{0};       //!< ACKs sent (reported through ack_sent())
+        size_t immediate_acks{0};  //!< segments that called for an immediate ACK
+        size_t delayed_acks{0};    //!< ACKs forced by expiry of the delayed-ACK timer
+    };
+
+    //! An ACK with a given ackno and ECE flag
+    struct EcnAck {
+        WrappingInt32 ackno;  //!< acknowledgment number
+        bool ece;             //!< ECN-echo flag
+    };
+
+  private:
     //! Our data structure for re-assembling bytes.
     StreamReassembler _reassembler;
 
@@ -32,12 +51,114 @@ class TCPReceiver {
     //! If FIN has been received.
     bool _fin_received{false};
 
+    //! If we offered timestamps in our own SYN.
+    bool _timestamps_offered{false};
+
+    //! If timestamps are in use (we offered them, and the peer's SYN carried them).
+    bool _timestamps{false};
+
+    //! The TSval to echo back to the peer ([RFC 7323](\ref rfc::rfc7323) TS.Recent).
+    std::optional<uint32_t> _ts_recent{};
+
+    //! The number of segments rejected by PAWS.
+    size_t _paws_rejected{0};
+
+    //! \brief Protection Against Wrapped Sequences
+    //! \returns `true` if the segment is an old duplicate (by its timestamp) and must be dropped
+    bool paws_reject(const TCPHeader &hdr);
+
+    //! The number of segments dropped because their (deferred) checksum was wrong.
+    size_t _bad_checksums{0};
+
+    //! \brief Header prediction: is the segment the next one expected, with data that fits the window?
+    //! \details Such a segment's payload goes straight into the stream, so a checksum left to be
+    //! verified can be verified as the payload is copied. Has no side effects.
+    bool predicted(const TCPHeader &hdr, const size_t payload_size) const;
+
+    //! \name Delayed-ACK state
+    //!@{
+    uint16_t _delack_timeout{0};       //!< delayed-ACK timer (0: acknowledge every segment)
+    unsigned _quickack{0};             //!< segments left to acknowledge immediately
+    bool _ack_due{false};              //!< an ACK should be sent now
+    std::optional<size_t> _delack{};   //!< milliseconds until the delayed ACK is due, if armed
+    size_t _full_sized_unacked{0};     //!< full-sized segments received since the last ACK
+    size_t _rcv_mss{0};                //!< largest payload seen from the peer
+    AckStats _ack_stats{};
+    //!@}
+
+    //! Sizes of the segments making up a received payload
+    struct SegmentCount {
+        size_t segments;      //!< number of segments coalesced into the payload
+        size_t segment_size;  //!< payload size of all but (possibly) the last of them
+    };
+
+    //! Decide whether the segment (or run of segments) should be acknowledged now or later
+    void update_ack_state(const TCPHeader &hdr,
+                          const size_t payload_size,
+                          const SegmentCount count,
+                          const uint64_t expected_seq,
+                          const bool had_holes);
+
+    //! Handle an inbound segment (`Payload` is a Buffer), or a run of coalesced segments (a BufferList)
+    //! \returns `false`, having changed nothing, if the payload was not pushed because its sum was not `sum`
+    template <typename Payload>
+    bool receive(const TCPHeader &hdr,
+                 const Payload &payload,
+                 const SegmentCount count,
+                 const bool ce,
+                 const std::optional<uint16_t> sum = std::nullopt);
+
+    //! Push a payload, already trimmed to the window, into the reassembler (if its sum is `sum`)
+    bool push_payload(const Buffer &payload, const uint64_t index, const bool fin, const std::optional<uint16_t> sum);
+    bool push_payload(const BufferList &payload,
+                      const uint64_t index,
+                      const bool fin,
+                      const std::optional<uint16_t> sum);
+
+    //! \name Receive-buffer auto-tuning state
+    //!@{
+    size_t _capacity_min;                          //!< capacity never shrinks below this
+    size_t _capacity_max;                          //!< capacity never grows beyond this
+    size_t _rtt_estimate{TCPConfig::TIMEOUT_DFLT};  //!< length of a measurement interval, in milliseconds
+    size_t _autotune_elapsed{0};                   //!< milliseconds since the current interval began
+    uint64_t _autotune_read_mark{0};               //!< bytes_read() when the current interval began
+    uint64_t _autotune_written_mark{0};            //!< bytes_written() when the current interval began
+    uint64_t _advertised_edge{0};                  //!< right edge of the last advertised window (stream index)
+    //!@}
+
+    //! Resize the buffers at the end of a measurement interval
+    void autotune();
+
+    //! Receiver-side silly window syndrome avoidance ([RFC 1122](\ref rfc::rfc1122), 4.2.3.3)
+    bool _sws_avoidance{false};
+
+    //! The MSS we advertised, which bounds the peer's segments
+    size_t _mss{TCPConfig::MAX_PAYLOAD_SIZE};
+
+    //! \name Explicit Congestion Notification state
+    //!@{
+    bool _ecn_offered{false};  //!< we offered ECN in our own SYN
+    bool _ecn{false};          //!< ECN was negotiated with the peer
+    bool _dctcp{false};        //!< echo the CE mark of each segment exactly (DCTCP), not until CWR
+    bool _ece{false};          //!< set ECE on outgoing ACKs
+    size_t _ce_marks{0};       //!< segments that arrived with the CE codepoint
+    std::optional<EcnAck> _ce_transition_ack{};  //!< ACK owed for data before a change of CE state
+    //!@}
+
+    //! Update the ECN-echo state for a segment that arrived with (or without) a CE mark
+    //! \param unacked_ackno the ackno before the segment, if data before it was not yet acknowledged
+    void update_ecn_state(const TCPHeader &hdr, const bool ce, const std::optional<WrappingInt32> unacked_ackno);
+
   public:
     //! \brief Construct a TCP receiver
     //!
     //! \param capacity the maximum number of bytes that the receiver will
     //!                 store in its buffers at any give time.
-    TCPReceiver(const size_t capacity) : _reassembler(capacity), _capacity(capacity) {}
+    TCPReceiver(const size_t capacity)
+        : _reassembler(capacity), _capacity(capacity), _capacity_min(capacity), _capacity_max(capacity) {}
+
+    //! \brief Construct a TCP receiver from a TCPConfig
+    explicit TCPReceiver(const TCPConfig &cfg);
 
     //! \name Accessors to provide feedback to the remote TCPSender
     //!@{
@@ -59,14 +180,101 @@ class TCPReceiver {
     //! the first byte that falls after the window (and will not be
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
+    //!
+    //! With TCPConfig::sws_avoidance, the right edge of the window only moves forward once it can
+    //! advance by at least min(MSS, capacity / 2); until then the previously advertised edge is kept.
     size_t window_size() const;
+
+    //! \brief The TSval to echo in the TSecr of our next segment
+    //! \returns empty if timestamps are not in use
+    std::optional<uint32_t> ts_recent() const { return _timestamps ? _ts_recent : std::nullopt; }
     //!@}
 
+    //! \brief number of segments dropped as old duplicates by PAWS
+    size_t paws_rejected() const { return _paws_rejected; }
+
+    //! \brief number of segments dropped because of a checksum left to the receiver to verify
+    //! \details See TCPSegment::parse(); the checksum of a predicted() segment is verified as its
+    //! payload is copied into the stream, and that of any other segment before it is processed.
+    size_t bad_checksums() const { return _bad_checksums; }
+
     //! \brief number of bytes stored but not yet reassembled
     size_t unassembled_bytes() const { return _reassembler.unassembled_bytes(); }
 
     //! \brief handle an inbound segment
-    void segment_received(const TCPSegment &seg);
+    //! \param ce whether the IP datagram carrying it was marked Congestion Experienced
+    void segment_received(const TCPSegment &seg, const bool ce = false);
+
+    //! \brief handle a run of consecutive segments merged by a TCPSegmentCoalescer
+    //! \param ce whether the datagrams carrying them were marked Congestion Experienced
+    void segment_received(const TCPSegmentRun &run, const bool ce = false);
+
+    //! \name Explicit Congestion Notification ([RFC 3168](\ref rfc::rfc3168))
+    //!@{
+
+    //! \brief Should our ACKs carry the ECE flag?
+    //!
+    //! Once ECN is negotiated, a CE-marked segment is acknowledged immediately, and ECE is set
+    //! on every ACK until the peer's CWR shows it has reduced its window. With TCPConfig::dctcp,
+    //! ECE instead reflects whether the latest segment was marked, and an ACK is sent as soon as
+    //! that changes, so the sender can measure what fraction of its data was marked.
+    bool ece() const { return _ece; }
+
+    //! \brief An ACK to send before the next one, for data received before the CE state changed (DCTCP)
+    //!
+    //! With delayed ACKs, data may be waiting to be acknowledged when a segment changes the CE state.
+    //! [RFC 8257](\ref rfc::rfc8257), 3.2, requires that data to be acknowledged with the old ECE
+    //! value first, so the sender credits each mark to the right bytes. When this is set, send an ACK
+    //! with its ackno and ECE flag, then the usual one; ack_sent() accounts for both.
+    const std::optional<EcnAck> &ce_transition_ack() const { return _ce_transition_ack; }
+
+    //! \brief number of segments that arrived marked Congestion Experienced
+    size_t ce_marks() const { return _ce_marks; }
+    //!@}
+
+    //! \name ACK policy
+    //!@{
+
+    //! \brief Should an ACK be sent now?
+    //!
+    //! Without delayed ACKs, every segment that occupies sequence space calls for an ACK.
+    //! With them, an ACK is due after every second full-sized segment, on out-of-order or
+    //! hole-filling data, on PSH/SYN/FIN, for the first few segments of the connection
+    //! ("quick-ack"), and when the delayed-ACK timer expires.
+    bool ack_due() const { return _ack_due; }
+
+    //! \brief An ACK (possibly piggybacked on data) carrying ackno() and window_size() was sent
+    void ack_sent();
+
+    //! \brief Notifies the TCPReceiver of the passage of time (runs the delayed-ACK timer)
+    void tick(const size_t ms_since_last_tick);
+
+    //! \brief Milliseconds until tick() has work to do (delayed ACK or auto-tuning), or empty if nothing is pending
+    //! \note As with TCPSender::next_timeout(), this lets the owner arm a TimerWheel timer instead of
+    //! ticking the receiver periodically; tick() must then be passed all the time elapsed since its
+    //! previous call.
+    std::optional<size_t> next_timeout() const;
+
+    //! \brief Counters describing how inbound segments were acknowledged
+    const AckStats &ack_stats() const { return _ack_stats; }
+    //!@}
+
+    //! \name Receive-buffer auto-tuning
+    //!@{
+
+    //! \brief The current capacity of the receive buffers
+    //!
+    //! With TCPConfig::recv_capacity_max set, the capacity is re-sized once per round trip
+    //! (as timed by tick()). If the application drained more than half the buffer during the
+    //! last round trip, the capacity grows to twice that amount, so the peer can keep a full
+    //! round trip of data in flight while the application catches up. After a round trip in
+    //! which nothing arrived or was read, it is halved, down to TCPConfig::recv_capacity.
+    //! Shrinking never pulls in the right edge of a window that was already advertised.
+    size_t capacity() const { return _capacity; }
+
+    //! \brief Set the round-trip time used as the measurement interval (e.g., the sender's SRTT)
+    void set_rtt_estimate(const size_t ms) { _rtt_estimate = std::max<size_t>(ms, 1); }
+    //!@}
 
     //! \name "Output" interface for the reader
     //!@{
@@ -1,37 +1,69 @@
 #include "tcp_sender.hh"
 
 #include "tcp_config.hh"
+#include "tcp_isn.hh"
+#include "util.hh"
 
-#include <random>
+#include <cmath>
+#include <cstdint>
+#include <utility>
 
 using namespace std;
 
 //! \param[in] capacity the capacity of the outgoing byte stream
 //! \param[in] retx_timeout the initial amount of time to wait before retransmitting the oldest outstanding segment
-//! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise uses a random ISN)
+//! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise one from ISNGenerator)
 TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
-    : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
+    : _isn(fixed_isn.has_value() ? fixed_isn.value() : ISNGenerator::isn())
     , _initial_retransmission_timeout{retx_timeout}
     , _stream(capacity) {
     _next_seqno = unwrap(_isn, _isn, 0);
     _rto = _initial_retransmission_timeout;
 }
 
+//! \param[in] cfg the capacity, timeout, ISN, MSS, Nagle and ECN settings to use
+TCPSender::TCPSender(const TCPConfig &cfg) : TCPSender(cfg.send_capacity, cfg.rt_timeout, cfg.fixed_isn) {
+    _advertised_mss = cfg.mss;
+    _mss = cfg.mss;
+    _timestamps = cfg.timestamps;
+    _nagle = cfg.nagle;
+    _ecn_offered = cfg.ecn;
+    _dctcp = cfg.ecn && cfg.dctcp;
+}
+
 uint64_t TCPSender::bytes_in_flight() const { return _next_seqno - _next_ackno; }
 
 TCPSender::OutStandingSegment TCPSender::send_segment(const bool syn,
                                                       const bool fin,
-                                                      std::optional<std::string> payload) {
+                                                      std::optional<Buffer> payload,
+                                                      const uint16_t payload_sum) {
     TCPSegment tcpSegment;
     tcpSegment.header().syn = syn;
     tcpSegment.header().fin = fin;
     tcpSegment.header().seqno = next_seqno();
+    if (syn) {
+        tcpSegment.header().options.mss = _advertised_mss;
+        // an ECN-setup SYN carries ECE and CWR; an ECN-setup SYN-ACK carries ECE alone
+        tcpSegment.header().ece = _peer_syn_seen ? _ecn : _ecn_offered;
+        tcpSegment.header().cwr = not _peer_syn_seen && _ecn_offered;
+    }
+    if (_cwr_pending && payload.has_value()) {
+        tcpSegment.header().cwr = true;
+        _cwr_pending = false;
+    }
+    if (_timestamps) {
+        tcpSegment.header().options.ts = TCPOptions::Timestamps{static_cast<uint32_t>(timestamp_ms()), 0};
+    }
 
     if (payload.has_value()) {
-        tcpSegment.payload() = Buffer(std::move(payload.value()));
+        // the sum is cached with the payload, so that serializing (or retransmitting) only sums the header
+        tcpSegment.set_payload(std::move(payload.value()), payload_sum);
     }
 
     OutStandingSegment outSegment(*this, tcpSegment);
+    if (_segments_outstanding.empty() && not _persist_timeout.has_value()) {
+        _sent_time = _timer;  // the retransmission timer starts with the first segment in flight
+    }
     _segments_out.push(tcpSegment);
     _segments_outstanding.push_back(outSegment);
 
@@ -42,7 +74,10 @@ TCPSender::OutStandingSegment TCPSender::send_segment(const bool syn,
     return outSegment;
 }
 
-void TCPSender::fill_window() {
+void TCPSender::fill_window() { fill_window(false); }
+
+//! \param[in] override_sws send even segments that worth_sending() would hold back
+void TCPSender::fill_window(const bool override_sws) {
     if (stream_in().eof() && next_seqno_absolute() == stream_in().bytes_written() + 2) {
         return;
     }
@@ -59,15 +94,47 @@ void TCPSender::fill_window() {
 
     // fill window with data
     while (_window && !_stream.eof() && _stream.buffer_size()) {
-        size_t read_size = min(TCPConfig::MAX_PAYLOAD_SIZE, min(_stream.buffer_size(), _window));
-        std::string payload = _stream.read(read_size);
-        send_segment(false, _stream.eof() && payload.size() < _window, payload);
+        size_t read_size = min(_mss, min(_stream.buffer_size(), _window));
+        if (_nagle && not _persist_timeout.has_value() && not override_sws && not worth_sending(read_size)) {
+            // with nothing in flight, no ACK will come to reconsider the data, so it goes on a timer
+            if (bytes_in_flight() == 0 && not _sws_override.has_value()) {
+                _sws_override = _timer + TCPConfig::SWS_OVERRIDE;
+            }
+            break;
+        }
+        uint16_t payload_sum = 0;
+        Buffer payload = _stream.read(read_size, payload_sum);  // summed as it is copied, into a pooled block
+        const bool fin = _stream.eof() && payload.size() < _window;
+        send_segment(false, fin, std::move(payload), payload_sum);
+        _sws_override.reset();
     }
+
+    // data (or a FIN) written while the window is shut needs the persist timer to get it out
+    update_persist_timer();
+}
+
+//! \param[in] len the payload size that the window and the stream allow
+//! \details Implements [RFC 1122](\ref rfc::rfc1122), 4.2.3.4: send a full-sized segment, or
+//! at least half the largest window the receiver has offered, or (Nagle) all the queued data
+//! when nothing is unacknowledged. The final segment of the stream is never held back.
+//! Data held back with nothing in flight is sent anyway when the override timer
+//! (TCPConfig::SWS_OVERRIDE) expires, since no ACK is coming to open the window further.
+bool TCPSender::worth_sending(const size_t len) const {
+    if (len >= _mss || 2 * len >= _max_window) {
+        return true;
+    }
+    const bool everything = len == _stream.buffer_size();
+    return everything && (bytes_in_flight() == 0 || _stream.input_ended());
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
 //! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+//! \param options The options carried by the ACK
+//! \param ece The ACK's ECN-echo flag
+void TCPSender::ack_received(const WrappingInt32 ackno,
+                             const uint16_t window_size,
+                             const TCPOptions &options,
+                             const bool ece) {
     uint64_t abs_ackno = unwrap(ackno, _isn, next_seqno_absolute());
 
     // ignore impossible ack
@@ -75,48 +142,244 @@ void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_si
         return;
     }
 
+    if (_ecn) {
+        ecn_ack_received(abs_ackno, abs_ackno > _next_ackno ? abs_ackno - _next_ackno : 0, ece);
+    }
+
+    // with timestamps, every ACK of new data echoes the TSval of the segment that triggered it,
+    // so it can be timed even if that segment was a retransmission (no need for Karn's rule)
+    if (_timestamps && options.ts.has_value() && abs_ackno > _next_ackno) {
+        const int32_t rtt = static_cast<uint32_t>(timestamp_ms()) - options.ts.value().ecr;
+        if (rtt >= 0) {
+            rtt_sample(rtt);
+        }
+    }
+
     // should remove some segments
     if (_segments_outstanding.size() && _segments_outstanding.front().fully_ack(abs_ackno)) {
         while (_segments_outstanding.size()) {
             auto segment = _segments_outstanding.front();
             if (segment.fully_ack(abs_ackno)) {
                 _segments_outstanding.pop_front();
-                _zero_window = false;
             } else {
                 break;
             }
         }
         _retx_cnt = 0;
-        _rto = _initial_retransmission_timeout;
+        _rto = base_rto();
         _sent_time = _timer;
+        if (_persist_timeout.has_value()) {
+            _persist_timeout = base_rto();  // the receiver is making progress
+        }
     }
+    _persist_probes = 0;
 
     _next_ackno = max(abs_ackno, _next_ackno);
 
-    // recalculate the capacity of receiver
-    _window = window_size - bytes_in_flight();
-    if (window_size == 0) {
-        _window = 1;
-        _zero_window = true;
+    _max_window = max<uint64_t>(_max_window, window_size);
+
+    // recalculate the capacity of receiver (and of the path, once it has signalled congestion)
+    const uint64_t limit = min<uint64_t>(window_size, _cwnd.value_or(window_size));
+    _window = limit > bytes_in_flight() ? limit - bytes_in_flight() : 0;
+    _zero_window = window_size == 0;
+    if (_zero_window) {
+        update_persist_timer();
+    } else if (_persist_timeout.has_value()) {
+        _persist_timeout.reset();
+        _rto = base_rto();
+        _sent_time = _timer;
     }
     fill_window();
 }
 
+//! \param[in] ack the header of a segment from the peer
+void TCPSender::ack_received(const TCPHeader &ack) {
+    // ECE on a SYN-ACK is ECN negotiation, not a congestion signal
+    ack_received(ack.ackno, ack.win, ack.options, ack.ece && not ack.syn);
+}
+
+//! \param[in] abs_ackno the absolute ackno of the ACK
+//! \param[in] newly_acked the number of sequence numbers it acknowledges for the first time
+//! \param[in] ece whether it echoed a CE mark
+//! \details Implements the sender side of [RFC 3168](\ref rfc::rfc3168), 6.1.2: the first ECE in a
+//! window halves the congestion window (the flight size, the first time) and sets CWR on the next
+//! new data; further ECEs are ignored until everything outstanding at that point is acknowledged.
+//! The window then grows by one MSS per window of acknowledged data.
+//!
+//! With DCTCP ([RFC 8257](\ref rfc::rfc8257)), the fraction F of bytes acknowledged with ECE is measured
+//! over each window of data and folded into alpha = (1 - g) * alpha + g * F, with g = 1/16, and the
+//! reduction is by a factor of (1 - alpha / 2) instead of one half.
+void TCPSender::ecn_ack_received(const uint64_t abs_ackno, const uint64_t newly_acked, const bool ece) {
+    if (_dctcp) {
+        _bytes_acked += newly_acked;
+        _bytes_marked += ece ? newly_acked : 0;
+        if (abs_ackno > _alpha_window_end) {
+            constexpr double g = 1.0 / 16;
+            const double fraction = _bytes_acked ? static_cast<double>(_bytes_marked) / _bytes_acked : 0;
+            _alpha = (1 - g) * _alpha + g * fraction;
+            _bytes_acked = 0;
+            _bytes_marked = 0;
+            _alpha_window_end = _next_seqno;
+        }
+    }
+
+    if (ece && abs_ackno > _recover) {
+        // at most one reduction per window of data
+        const uint64_t flight = _cwnd.value_or(bytes_in_flight());
+        const uint64_t reduced = _dctcp ? static_cast<uint64_t>(flight * (1 - _alpha / 2)) : flight / 2;
+        _cwnd = max<uint64_t>(reduced, 2 * _mss);
+        _cwnd_acked = 0;
+        _recover = _next_seqno;
+        _cwr_pending = true;
+        return;
+    }
+
+    // congestion avoidance: one MSS per window acknowledged, but not while recovering from a reduction
+    if (_cwnd.has_value() && abs_ackno > _recover) {
+        _cwnd_acked += newly_acked;
+        if (_cwnd_acked >= _cwnd.value()) {
+            _cwnd_acked -= _cwnd.value();
+            _cwnd.value() += _mss;
+        }
+    }
+}
+
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
     _timer += ms_since_last_tick;
+
+    // RFC 1122's override timeout: data held back for a small window goes out after all
+    if (_sws_override.has_value() && _sws_override.value() <= _timer) {
+        _sws_override.reset();
+        fill_window(true);
+    }
+
+    // while the window is zero, probe it with exponential backoff (up to TCPConfig::MAX_RTO)
+    if (_persist_timeout.has_value()) {
+        if (_sent_time + _persist_timeout.value() <= _timer) {
+            _sent_time = _timer;
+            if (send_probe()) {
+                _persist_timeout = min<unsigned int>(2 * _persist_timeout.value(), TCPConfig::MAX_RTO);
+                _persist_probes++;
+            } else {
+                _persist_timeout.reset();  // nothing left to probe with; fill_window() restarts it if need be
+            }
+        }
+        return;
+    }
+
     // check timeout segment
     if (_sent_time + _rto <= _timer && _segments_outstanding.size()) {
-        auto segment = _segments_outstanding.front();
+        auto &segment = _segments_outstanding.front();
+        auto &ts = segment.tcp_segment().header().options.ts;
+        if (ts.has_value()) {
+            ts.value().val = static_cast<uint32_t>(timestamp_ms());
+        }
         _segments_out.push(segment.tcp_segment());
         _sent_time = _timer;
-        _rto <<= 1 - _zero_window;
+        _rto <<= 1;
         _retx_cnt++;
     }
 }
 
+//! \details The persist timer takes over from the retransmission timer until the window opens. It does not
+//!          run with nothing outstanding and nothing (data or FIN) left to send, since there is then
+//!          nothing to probe with, and an idle connection should not wake up for it.
+void TCPSender::update_persist_timer() {
+    if (not _zero_window) {
+        return;
+    }
+    const bool fin_unsent = _stream.input_ended() && _next_seqno < _stream.bytes_written() + 2;
+    if (_segments_outstanding.empty() && _stream.buffer_empty() && not fin_unsent) {
+        _persist_timeout.reset();
+    } else if (not _persist_timeout.has_value()) {
+        _persist_timeout = base_rto();
+        _sent_time = _timer;
+    }
+}
+
+//! \details The probe is the oldest unacknowledged segment if there is one (usually the previous
+//!          probe), and otherwise one new byte of the stream (or the FIN).
+bool TCPSender::send_probe() {
+    if (_segments_outstanding.empty()) {
+        const uint64_t next = _next_seqno;
+        _window = 1;
+        fill_window();
+        _window = 0;
+        return _next_seqno != next;
+    }
+
+    auto &segment = _segments_outstanding.front();
+    auto &ts = segment.tcp_segment().header().options.ts;
+    if (ts.has_value()) {
+        ts.value().val = static_cast<uint32_t>(timestamp_ms());
+    }
+    _segments_out.push(segment.tcp_segment());
+    return true;
+}
+
 unsigned int TCPSender::consecutive_retransmissions() const { return _retx_cnt; }
 
+optional<size_t> TCPSender::next_timeout() const {
+    optional<size_t> deadline = _sws_override;
+    if (not _segments_outstanding.empty() || _persist_timeout.has_value()) {
+        deadline = min<size_t>(deadline.value_or(SIZE_MAX), _sent_time + _persist_timeout.value_or(_rto));
+    }
+    if (not deadline.has_value()) {
+        return {};
+    }
+    return deadline.value() > _timer ? deadline.value() - _timer : 0;
+}
+
+//! \param[in] peer_syn_options the options carried by the peer's SYN
+//! \details The effective MSS is the smaller of ours and the peer's (raised to TCPConfig::MIN_MSS, but
+//!          never above ours); a peer that doesn't send the option leaves our own MSS in effect.
+void TCPSender::negotiate(const TCPOptions &peer_syn_options) {
+    if (peer_syn_options.mss.has_value()) {
+        _mss = min<size_t>(_advertised_mss, max<size_t>(TCPConfig::MIN_MSS, peer_syn_options.mss.value()));
+    }
+    // timestamps are only used if both sides offer them
+    _timestamps = _timestamps && peer_syn_options.ts.has_value();
+}
+
+//! \param[in] peer_syn the header of the peer's SYN or SYN-ACK
+//! \details ECN is in use if we offered it and the peer agreed: its SYN carried ECE and CWR, or
+//!          (answering our SYN) its SYN-ACK carried ECE without CWR ([RFC 3168](\ref rfc::rfc3168), 6.1.1).
+void TCPSender::negotiate(const TCPHeader &peer_syn) {
+    negotiate(peer_syn.options);
+    if (peer_syn.ack) {
+        _ecn = _ecn_offered && peer_syn.ece && not peer_syn.cwr;
+    } else {
+        _ecn = _ecn_offered && peer_syn.ece && peer_syn.cwr;
+    }
+    _dctcp = _dctcp && _ecn;
+    if (next_seqno_absolute() == 0) {
+        _peer_syn_seen = true;  // our SYN, still to be sent, answers the peer's
+    }
+}
+
+//! \param[in] rtt_ms the measured round-trip time
+void TCPSender::rtt_sample(const uint64_t rtt_ms) {
+    const double r = rtt_ms;
+    if (not _srtt.has_value()) {
+        _srtt = r;
+        _rttvar = r / 2;
+    } else {
+        _rttvar = 0.75 * _rttvar + 0.25 * fabs(_srtt.value() - r);
+        _srtt = 0.875 * _srtt.value() + 0.125 * r;
+    }
+    _rtt_samples++;
+}
+
+//! \returns the configured initial RTO until an RTT sample is available, then SRTT + 4 * RTTVAR (clamped)
+unsigned int TCPSender::base_rto() const {
+    if (not _srtt.has_value()) {
+        return _initial_retransmission_timeout;
+    }
+    const double rto = _srtt.value() + max(1.0, 4 * _rttvar);
+    return clamp<unsigned int>(ceil(rto), TCPConfig::MIN_RTO, TCPConfig::MAX_RTO);
+}
+
 void TCPSender::send_empty_segment() {
     TCPSegment segment;
     _segments_out.push(segment);
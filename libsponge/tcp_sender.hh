@@ -48,12 +48,83 @@ class TCPSender {
     //! the window size (size can be sent to IP), initially 1 bytes
     uint64_t _window{1};
 
+    //! the MSS we advertise in our SYN
+    uint16_t _advertised_mss{TCPConfig::MAX_PAYLOAD_SIZE};
+
+    //! the largest payload we put in one segment, min(our MSS, the peer's MSS)
+    size_t _mss{TCPConfig::MAX_PAYLOAD_SIZE};
+
+    //! stamp outgoing segments with the timestamps option (offered, and not refused by the peer)
+    bool _timestamps{false};
+
+    //! smoothed round-trip time, in milliseconds (empty until the first RTT sample)
+    std::optional<double> _srtt{};
+
+    //! round-trip time variation, in milliseconds
+    double _rttvar{0};
+
+    //! the number of RTT samples taken
+    size_t _rtt_samples{0};
+
+    //! feed an RTT measurement into the [RFC 6298](\ref rfc::rfc6298) estimator
+    void rtt_sample(const uint64_t rtt_ms);
+
+    //! the RTO to use when the timer is restarted (before any backoff)
+    unsigned int base_rto() const;
+
     //! the number of times retransmite a segment
     size_t _retx_cnt{0};
 
-    //! this byte was sent because window size is `0`
+    //! \name Persist timer (probing a zero window)
+    //!@{
+    std::optional<unsigned int> _persist_timeout{};  //!< current probe interval, while the peer's window is zero
+    unsigned int _persist_probes{0};                 //!< probes sent since the peer's last ACK
+    //!@}
+
+    //! the peer's last ACK advertised a zero window
     bool _zero_window{false};
 
+    //! send (or resend) a one-byte probe into a zero window
+    //! \returns `false` if there is nothing to probe with
+    bool send_probe();
+
+    //! run the persist timer while the window is zero and there is something to probe it with
+    void update_persist_timer();
+
+    //! Nagle's algorithm and sender-side SWS avoidance are enabled
+    bool _nagle{false};
+
+    //! the largest window the receiver has offered
+    uint64_t _max_window{0};
+
+    //! may a segment with `len` bytes of payload be sent now, or should it wait for more data?
+    bool worth_sending(const size_t len) const;
+
+    //! when (by _timer) to send data held back by worth_sending() with nothing in flight, if any is
+    std::optional<size_t> _sws_override{};
+
+    //! fill the window, sending small segments regardless of worth_sending() if `override_sws` is set
+    void fill_window(const bool override_sws);
+
+    //! \name Explicit Congestion Notification state
+    //!@{
+    bool _ecn_offered{false};         //!< offer ECN in our SYN
+    bool _ecn{false};                 //!< ECN was negotiated with the peer
+    bool _peer_syn_seen{false};       //!< the peer's SYN arrived before ours was sent (ours is a SYN-ACK)
+    bool _dctcp{false};               //!< scale the response to the fraction of marked bytes
+    std::optional<uint64_t> _cwnd{};  //!< congestion window in bytes (empty until the first congestion signal)
+    uint64_t _cwnd_acked{0};          //!< bytes acknowledged towards the next increase of the congestion window
+    uint64_t _recover{0};             //!< don't reduce the window again until this absolute seqno is acknowledged
+    bool _cwr_pending{false};         //!< set CWR on the next segment carrying new data
+    double _alpha{1.0};               //!< DCTCP's estimate of the fraction of marked bytes
+    uint64_t _alpha_window_end{0};    //!< the current DCTCP observation window ends when this is acknowledged
+    uint64_t _bytes_acked{0};         //!< bytes acknowledged during the current observation window
+    uint64_t _bytes_marked{0};        //!< ... of which by ACKs that carried ECE
+    //!@}
+
+    //! update the congestion window for an ACK of `newly_acked` bytes, which may have echoed a CE mark
+    void ecn_ack_received(const uint64_t abs_ackno, const uint64_t newly_acked, const bool ece);
+
     //! the encapsulation of a TCPSegment that indicate a oustanding segment
     class OutStandingSegment {
       private:
@@ -84,7 +155,11 @@ class TCPSender {
     //! outstanding segments that the TCPSender already sent but no ack.
     std::list<OutStandingSegment> _segments_outstanding{};
 
-    OutStandingSegment send_segment(const bool syn, const bool fin, const std::optional<std::string> payload = {});
+    //! Send a segment with `payload` (if any), whose one's-complement sum is `payload_sum`
+    OutStandingSegment send_segment(const bool syn,
+                                    const bool fin,
+                                    const std::optional<Buffer> payload = {},
+                                    const uint16_t payload_sum = 0);
 
   public:
     //! Initialize a TCPSender
@@ -92,6 +167,9 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from a TCPConfig
+    explicit TCPSender(const TCPConfig &cfg);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -102,16 +180,33 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \note If `options` carries a timestamp echo (TSecr), the ACK yields an RTT sample
+    //! \note With ECN in use, `ece` (the ACK's ECE flag) reports congestion on the path
+    void ack_received(const WrappingInt32 ackno,
+                      const uint16_t window_size,
+                      const TCPOptions &options = {},
+                      const bool ece = false);
+
+    //! \brief A new acknowledgment was received (takes the ackno, window, options and ECE flag from `ack`)
+    void ack_received(const TCPHeader &ack);
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
 
+    //! \brief The peer's SYN arrived; adopt the options it carried (e.g. its MSS)
+    void negotiate(const TCPOptions &peer_syn_options);
+
+    //! \brief The peer's SYN (or SYN-ACK) arrived; adopt its options and negotiate ECN
+    void negotiate(const TCPHeader &peer_syn);
+
     //! \brief create and send segments to fill as much of the window as possible
     void fill_window();
 
     //! \brief Notifies the TCPSender of the passage of time
     void tick(const size_t ms_since_last_tick);
+
+    //! \brief Turn off Nagle's algorithm (and sender-side SWS avoidance), like `TCP_NODELAY`
+    void set_nodelay(const bool nodelay) { _nagle = not nodelay; }
     //!@}
 
     //! \name Accessors
@@ -125,6 +220,43 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief Number of zero-window probes that went unanswered (sent since the peer's last ACK)
+    //! \note Probes are not retransmissions: a peer that keeps answering them with a zero window
+    //! is alive ([RFC 1122](\ref rfc::rfc1122), 4.2.2.17), so they don't count towards
+    //! TCPConfig::MAX_RETX_ATTEMPTS.
+    unsigned int persist_probes() const { return _persist_probes; }
+
+    //! \brief Milliseconds until tick() has work to do, or empty if no timer (retransmission, persist or
+    //! SWS override) is running
+    //! \note Rather than ticking every sender periodically, the owner can arm a TimerWheel timer for
+    //! this deadline, passing tick() all the time elapsed since its previous call when it fires.
+    //! The deadline must be re-read after every other call that can start or restart the timer.
+    std::optional<size_t> next_timeout() const;
+
+    //! \brief Largest payload the TCPSender will put in one segment
+    size_t mss() const { return _mss; }
+
+    //! \brief Whether outgoing segments carry the timestamps option
+    //! \note The TCPSender sets TSval; the TCPConnection fills in TSecr from TCPReceiver::ts_recent()
+    bool timestamps_enabled() const { return _timestamps; }
+
+    //! \brief Number of RTT samples taken so far
+    size_t rtt_samples() const { return _rtt_samples; }
+
+    //! \brief Smoothed round-trip time in milliseconds, if any sample has been taken
+    std::optional<double> srtt() const { return _srtt; }
+
+    //! \brief Whether ECN was negotiated
+    //! \note The IP layer should then mark the datagrams carrying new data as ECN-capable (ECT(0))
+    bool ecn_enabled() const { return _ecn; }
+
+    //! \brief The congestion window, in bytes
+    //! \returns empty until the path has signalled congestion (the window is then unlimited)
+    std::optional<uint64_t> cwnd() const { return _cwnd; }
+
+    //! \brief DCTCP's moving estimate of the fraction of bytes that were marked
+    double dctcp_alpha() const { return _alpha; }
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
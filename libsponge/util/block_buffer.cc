@@ -0,0 +1,175 @@
+#include "block_buffer.hh"
+
+#include "checksum.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+//! The part of a range of bytes that lies in one block
+struct Piece {
+    size_t block;   //!< number of the block
+    size_t offset;  //!< offset of the piece in the block
+    size_t done;    //!< bytes of the range before the piece
+    size_t size;    //!< bytes in the piece
+};
+
+//! Call `f` with each Piece of the `len` bytes from `index` on
+template <typename F>
+void for_each_piece(const size_t index, const size_t len, F &&f) {
+    for (size_t done = 0; done < len;) {
+        const size_t offset = (index + done) % BlockBuffer::BLOCK;
+        const size_t n = min(len - done, BlockBuffer::BLOCK - offset);
+        f(Piece{(index + done) / BlockBuffer::BLOCK, offset, done, n});
+        done += n;
+    }
+}
+
+//! One's-complement sum of pieces summed separately
+//! \details A piece that begins at an odd offset begins in the middle of a word, which swaps its sum's
+//! bytes (see InternetChecksum::add()).
+class PieceSum {
+    uint32_t _sum{0};
+    bool _odd{false};
+
+  public:
+    void add(uint16_t sum, const size_t len) {
+        if (_odd) {
+            sum = static_cast<uint16_t>((sum << 8) | (sum >> 8));
+        }
+        _sum = (_sum & 0xffff) + (_sum >> 16) + sum;
+        _odd ^= (len % 2 == 1);
+    }
+
+    uint16_t value() const {
+        uint32_t sum = _sum;
+        while (sum > 0xffff) {
+            sum = (sum & 0xffff) + (sum >> 16);
+        }
+        return static_cast<uint16_t>(sum);
+    }
+};
+
+}  // namespace
+
+BlockBuffer::BlockBuffer(const BlockBuffer &other) : _first(other._first) {
+    for (const auto &from : other._blocks) {
+        BufferStorage::Ptr copy{};
+        if (from) {
+            copy = BufferPool::allocate(BLOCK);
+            memcpy(copy->data(), from->data(), BLOCK);
+        }
+        _blocks.push_back(std::move(copy));
+    }
+}
+
+BlockBuffer &BlockBuffer::operator=(const BlockBuffer &other) {
+    if (this != &other) {
+        *this = BlockBuffer{other};
+    }
+    return *this;
+}
+
+char *BlockBuffer::block(const size_t number) {
+    if (number < _first) {
+        throw out_of_range("BlockBuffer: write before the bytes kept");
+    }
+    while (_blocks.size() <= number - _first) {
+        _blocks.push_back({});
+    }
+    BufferStorage::Ptr &storage = _blocks[number - _first];
+    if (not storage) {
+        storage = BufferPool::allocate(BLOCK);
+    }
+    return storage->data();
+}
+
+const char *BlockBuffer::block(const size_t number) const {
+    if (number < _first || number - _first >= _blocks.size() || not _blocks[number - _first]) {
+        throw out_of_range("BlockBuffer: read of bytes never written");
+    }
+    return _blocks[number - _first]->data();
+}
+
+//! \param[in] index the stream index of the first byte
+//! \param[in] data the bytes
+void BlockBuffer::write(const size_t index, const string_view data) {
+    for_each_piece(index, data.size(), [&](const Piece &piece) {
+        memcpy(block(piece.block) + piece.offset, data.data() + piece.done, piece.size);
+    });
+}
+
+//! \param[in] index the stream index of the first byte
+//! \param[in] data the bytes
+//! \returns their sum
+uint16_t BlockBuffer::write_and_sum(const size_t index, const string_view data) {
+    PieceSum sum;
+    const auto *src = reinterpret_cast<const uint8_t *>(data.data());
+    for_each_piece(index, data.size(), [&](const Piece &piece) {
+        auto *dst = reinterpret_cast<uint8_t *>(block(piece.block) + piece.offset);
+        sum.add(ChecksumKernel::copy_and_sum(dst, src + piece.done, piece.size), piece.size);
+    });
+    return sum.value();
+}
+
+//! \param[in] index the stream index of the first byte
+//! \param[out] dst where to copy the bytes
+//! \param[in] len the number of bytes
+void BlockBuffer::read(const size_t index, char *dst, const size_t len) const {
+    for_each_piece(index, len, [&](const Piece &piece) {
+        memcpy(dst + piece.done, block(piece.block) + piece.offset, piece.size);
+    });
+}
+
+//! \param[in] index the stream index of the first byte
+//! \param[out] dst where to copy the bytes
+//! \param[in] len the number of bytes
+//! \returns their sum
+uint16_t BlockBuffer::read_and_sum(const size_t index, char *dst, const size_t len) const {
+    PieceSum sum;
+    for_each_piece(index, len, [&](const Piece &piece) {
+        const auto *src = reinterpret_cast<const uint8_t *>(block(piece.block) + piece.offset);
+        sum.add(ChecksumKernel::copy_and_sum(reinterpret_cast<uint8_t *>(dst + piece.done), src, piece.size),
+                piece.size);
+    });
+    return sum.value();
+}
+
+//! \param[in] index the stream index of the first byte
+//! \param[in] len the number of bytes wanted
+//! \returns the bytes up to `len` or the end of the block holding `index`, whichever comes first
+string_view BlockBuffer::contiguous(const size_t index, const size_t len) const {
+    if (len == 0) {
+        return {};
+    }
+    const size_t offset = index % BLOCK;
+    return {block(index / BLOCK) + offset, min(len, BLOCK - offset)};
+}
+
+//! \param[in] begin the first index still wanted
+//! \param[in] end one past the last index still wanted
+//! \details Later writes must not be before `begin`.
+void BlockBuffer::keep(const size_t begin, const size_t end) {
+    const size_t first = begin / BLOCK;
+    if (begin >= end || first >= _first + _blocks.size()) {
+        _blocks.clear();
+        _first = first;
+        return;
+    }
+    for (; _first < first; _first++) {
+        _blocks.pop_front();
+    }
+    const size_t last = (end - 1) / BLOCK;
+    while (_first + _blocks.size() - 1 > last) {
+        _blocks.pop_back();
+    }
+}
+
+size_t BlockBuffer::blocks() const {
+    return static_cast<size_t>(count_if(
+        _blocks.begin(), _blocks.end(), [](const BufferStorage::Ptr &storage) { return static_cast<bool>(storage); }));
+}
@@ -0,0 +1,67 @@
+#ifndef SPONGE_LIBSPONGE_BLOCK_BUFFER_HH
+#define SPONGE_LIBSPONGE_BLOCK_BUFFER_HH
+
+#include "buffer_storage.hh"
+#include "small_vector.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//! \brief Bytes addressed by their stream index, kept in fixed-size blocks from the BufferPool
+//!
+//! The storage behind ByteStream and StreamReassembler. The byte at index `i` lives at offset
+//! `i % BLOCK` of block `i / BLOCK`, so bytes are never moved once written. A block is allocated
+//! when a byte in it is first written and freed by keep() once no byte in it is wanted, so the
+//! memory held follows the bytes actually buffered (none when idle) rather than the capacity,
+//! and every block comes from the BufferPool, and so from a HugePageArena if one was passed to
+//! BufferPool::set_arena(). Blocks between written ones (gaps in a reassembler's window) are not
+//! allocated.
+class BlockBuffer {
+  public:
+    static constexpr size_t BLOCK = 16 * 1024;  //!< bytes in each block (one of BufferPool's sizes)
+
+  private:
+    SmallVector<BufferStorage::Ptr, 4> _blocks{};  //!< block `_first + i`, if it has been written to
+    size_t _first{0};                               //!< number of the first block in _blocks
+
+    //! The bytes of block `number` (which must not be before _first), allocated if need be
+    char *block(const size_t number);
+
+    //! The bytes of block `number`, which must have been written to
+    const char *block(const size_t number) const;
+
+  public:
+    BlockBuffer() = default;
+
+    //! \brief A copy with blocks of its own
+    BlockBuffer(const BlockBuffer &other);
+    BlockBuffer &operator=(const BlockBuffer &other);
+    BlockBuffer(BlockBuffer &&other) = default;
+    BlockBuffer &operator=(BlockBuffer &&other) = default;
+    ~BlockBuffer() = default;
+
+    //! \brief Copy `data` to indices [`index`, `index + data.size()`)
+    //! \note `index` must not be before the `begin` last passed to keep()
+    void write(const size_t index, const std::string_view data);
+
+    //! \brief As write(), returning the one's-complement sum of the bytes (see ChecksumKernel)
+    uint16_t write_and_sum(const size_t index, const std::string_view data);
+
+    //! \brief Copy the bytes at indices [`index`, `index + len`), which must have been written, to `dst`
+    void read(const size_t index, char *dst, const size_t len) const;
+
+    //! \brief As read(), returning the one's-complement sum of the bytes (see ChecksumKernel)
+    uint16_t read_and_sum(const size_t index, char *dst, const size_t len) const;
+
+    //! \brief As many of the `len` bytes from `index` on as are contiguous (at least one, if `len` > 0)
+    std::string_view contiguous(const size_t index, const size_t len) const;
+
+    //! \brief Free every block that holds no index in [`begin`, `end`) (all of them, if the range is empty)
+    void keep(const size_t begin, const size_t end);
+
+    //! \brief Number of blocks allocated
+    size_t blocks() const;
+};
+
+#endif  // SPONGE_LIBSPONGE_BLOCK_BUFFER_HH
@@ -7,11 +7,34 @@ void Buffer::remove_prefix(const size_t n) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    if (_storage and _starting_offset + _ending_offset == _storage->size()) {
         _storage.reset();
     }
 }
 
+void Buffer::remove_suffix(const size_t n) {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _ending_offset += n;
+    if (_storage and _starting_offset + _ending_offset == _storage->size()) {
+        _storage.reset();
+    }
+}
+
+//! \param[in] pos the offset of the first byte
+//! \param[in] len the number of bytes wanted
+Buffer Buffer::substr(const size_t pos, const size_t len) const {
+    const size_t total = size();
+    if (pos > total) {
+        throw out_of_range("Buffer::substr");
+    }
+    Buffer ret = *this;
+    ret.remove_suffix(total - pos - min(len, total - pos));
+    ret.remove_prefix(pos);
+    return ret;
+}
+
 void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
@@ -64,6 +87,81 @@ void BufferList::remove_prefix(size_t n) {
     }
 }
 
+void BufferList::remove_suffix(size_t n) {
+    while (n > 0) {
+        if (_buffers.empty()) {
+            throw std::out_of_range("BufferList::remove_suffix");
+        }
+
+        if (n < _buffers.back().str().size()) {
+            _buffers.back().remove_suffix(n);
+            n = 0;
+        } else {
+            n -= _buffers.back().str().size();
+            _buffers.pop_back();
+        }
+    }
+}
+
+//! \param[in] data the packet's initial contents, e.g. a payload
+//! \param[in] headroom bytes to reserve in front of them for headers
+PacketBuffer::PacketBuffer(const string_view data, const size_t headroom)
+    : _storage(BufferPool::allocate(headroom + data.size())), _head(headroom) {
+    data.copy(_storage->data() + headroom, data.size());
+}
+
+//! \param[in] n the size of the header to be written
+//! \details The bytes just in front of the packet are reused, unless a Buffer from buffer() still sees them
+//! (because a prefix was removed after it was handed out) or there are too few: then the packet is copied
+//! to a new allocation with `n` bytes more than the default headroom.
+uint8_t *PacketBuffer::prepend(const size_t n) {
+    if (n > _head || (_head > _shared_from && _storage.use_count() > 1)) {
+        auto storage = BufferPool::allocate(n + DEFAULT_HEADROOM + size());
+        str().copy(storage->data() + n + DEFAULT_HEADROOM, size());
+        _storage = std::move(storage);
+        _head = n + DEFAULT_HEADROOM;
+        _shared_from = SIZE_MAX;
+    }
+    _head -= n;
+    return reinterpret_cast<uint8_t *>(_storage->data() + _head);
+}
+
+void PacketBuffer::remove_prefix(const size_t n) {
+    if (n > size()) {
+        throw out_of_range("PacketBuffer::remove_prefix");
+    }
+    _head += n;
+}
+
+Buffer PacketBuffer::buffer() {
+    _shared_from = min(_shared_from, _head);
+    return {_storage, _head};
+}
+
+//! \param[in] pos the offset of the first byte
+//! \param[in] len the number of bytes wanted
+//! \details Buffers wholly outside the range are skipped, and the two at its ends sliced.
+BufferList BufferList::substr(size_t pos, size_t len) const {
+    if (pos > size()) {
+        throw out_of_range("BufferList::substr");
+    }
+    BufferList ret;
+    for (const auto &buf : _buffers) {
+        if (len == 0) {
+            break;
+        }
+        if (pos >= buf.size()) {
+            pos -= buf.size();
+            continue;
+        }
+        const Buffer slice = buf.substr(pos, len);
+        ret._buffers.push_back(slice);
+        len -= slice.size();
+        pos = 0;
+    }
+    return ret;
+}
+
 BufferViewList::BufferViewList(const BufferList &buffers) {
     for (const auto &x : buffers.buffers()) {
         _views.push_back(x);
@@ -102,3 +200,13 @@ vector<iovec> BufferViewList::as_iovecs() const {
     }
     return ret;
 }
+
+//! \param[out] iovecs the array to fill
+//! \param[in] max the number of elements in `iovecs`
+size_t BufferViewList::as_iovecs(iovec *iovecs, const size_t max) const {
+    const size_t count = min(max, _views.size());
+    for (size_t i = 0; i < count; i++) {
+        iovecs[i] = {const_cast<char *>(_views[i].data()), _views[i].size()};
+    }
+    return count;
+}
@@ -1,8 +1,11 @@
 #ifndef SPONGE_LIBSPONGE_BUFFER_HH
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
+#include "buffer_storage.hh"
+#include "small_vector.hh"
+
 #include <algorithm>
-#include <deque>
+#include <cstdint>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
@@ -14,14 +17,24 @@
 //! \brief A reference-counted read-only string that can discard bytes from the front
 class Buffer {
   private:
-    std::shared_ptr<std::string> _storage{};
+    friend class PacketBuffer;
+
+    BufferStorage::Ptr _storage{};
     size_t _starting_offset{};
+    size_t _ending_offset{};
+
+    //! \brief Share bytes [`starting_offset`, `storage->size()`) of `storage`
+    Buffer(BufferStorage::Ptr storage, const size_t starting_offset)
+        : _storage(std::move(storage)), _starting_offset(starting_offset) {}
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept : _storage(BufferStorage::adopt(std::move(str))) {}
+
+    //! \brief Construct from storage whose bytes have been filled in, e.g. a block from BufferPool::allocate()
+    explicit Buffer(BufferStorage::Ptr storage) noexcept : _storage(std::move(storage)) {}
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +42,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset - _ending_offset};
     }
 
     operator std::string_view() const { return str(); }
@@ -47,6 +60,14 @@ class Buffer {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
+    void remove_suffix(const size_t n);
+
+    //! \brief The `len` bytes (or as many as there are) starting at `pos`, sharing this Buffer's storage
+    //! \throws std::out_of_range if `pos` is past the end
+    Buffer substr(const size_t pos, const size_t len = std::string_view::npos) const;
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -55,8 +76,12 @@ class Buffer {
 //! encapsulate a TCP payload in a TCPSegment, and then encapsulate
 //! the TCPSegment in an IPv4Datagram) without copying the payload.
 class BufferList {
+  public:
+    static constexpr size_t INLINE_BUFFERS = 4;  //!< Buffers held without a separate allocation
+    using Buffers = SmallVector<Buffer, INLINE_BUFFERS>;
+
   private:
-    std::deque<Buffer> _buffers{};
+    Buffers _buffers{};
 
   public:
     //! \name Constructors
@@ -65,7 +90,7 @@ class BufferList {
     BufferList() = default;
 
     //! \brief Construct from a Buffer
-    BufferList(Buffer buffer) : _buffers{buffer} {}
+    BufferList(Buffer buffer) { _buffers.push_back(std::move(buffer)); }
 
     //! \brief Construct by taking ownership of a std::string
     BufferList(std::string &&str) noexcept {
@@ -74,8 +99,8 @@ class BufferList {
     }
     //!@}
 
-    //! \brief Access the underlying queue of Buffers
-    const std::deque<Buffer> &buffers() const { return _buffers; }
+    //! \brief Access the underlying sequence of Buffers
+    const Buffers &buffers() const { return _buffers; }
 
     //! \brief Append a BufferList
     void append(const BufferList &other);
@@ -87,6 +112,13 @@ class BufferList {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    void remove_suffix(size_t n);
+
+    //! \brief The `len` bytes (or as many as there are) starting at `pos`, sharing the Buffers' storage
+    //! \throws std::out_of_range if `pos` is past the end
+    BufferList substr(const size_t pos, const size_t len = std::string_view::npos) const;
+
     //! \brief Size of the string
     size_t size() const;
 
@@ -94,9 +126,59 @@ class BufferList {
     std::string concatenate() const;
 };
 
+//! \brief A packet being built from the payload outwards, in one allocation with room reserved in front
+//!
+//! Like the kernel's `sk_buff`: each layer prepend()s its header into the headroom, so that the TCP,
+//! IPv4 and Ethernet headers end up contiguous with the payload, instead of each layer chaining another
+//! Buffer (and another allocation) onto a BufferList that writev(2) must then gather. If the headroom
+//! runs out, the packet moves to a larger allocation.
+//!
+//! A PacketBuffer has a single owner, but buffer() hands out read-only Buffer%s that share its bytes;
+//! prepend() never overwrites a byte that such a Buffer can see.
+class PacketBuffer {
+  public:
+    static constexpr size_t DEFAULT_HEADROOM = 14 + 60 + 60;  //!< Ethernet, IPv4 and TCP headers, with options
+
+  private:
+    BufferStorage::Ptr _storage;    //!< headroom, then the packet
+    size_t _head;                   //!< offset of the packet's first byte
+    size_t _shared_from{SIZE_MAX};  //!< lowest offset that a Buffer handed out by buffer() can see
+
+  public:
+    //! \brief Construct holding a copy of `data`, with `headroom` bytes free in front of it
+    explicit PacketBuffer(const std::string_view data = {}, const size_t headroom = DEFAULT_HEADROOM);
+
+    PacketBuffer(PacketBuffer &&other) = default;
+    PacketBuffer &operator=(PacketBuffer &&other) = default;
+    PacketBuffer(const PacketBuffer &other) = delete;
+    PacketBuffer &operator=(const PacketBuffer &other) = delete;
+    ~PacketBuffer() = default;
+
+    //! \brief Grow the packet by `n` bytes at the front
+    //! \returns a pointer to the new first byte, for the caller to write a header to
+    uint8_t *prepend(const size_t n);
+
+    //! \brief Discard the first `n` bytes (e.g., a header that has been parsed), returning them to the headroom
+    void remove_prefix(const size_t n);
+
+    //! \brief Bytes free in front of the packet
+    size_t headroom() const { return _head; }
+
+    //! \brief Size of the packet
+    size_t size() const { return _storage->size() - _head; }
+
+    //! \brief The packet's bytes
+    std::string_view str() const { return {_storage->data() + _head, size()}; }
+
+    operator std::string_view() const { return str(); }
+
+    //! \brief A Buffer of the packet as it is now, sharing its storage
+    Buffer buffer();
+};
+
 //! \brief A non-owning temporary view (similar to std::string_view) of a discontiguous string
 class BufferViewList {
-    std::deque<std::string_view> _views{};
+    SmallVector<std::string_view, BufferList::INLINE_BUFFERS> _views{};
 
   public:
     //! \name Constructors
@@ -111,6 +193,9 @@ class BufferViewList {
     //! \brief Construct from a BufferList
     BufferViewList(const BufferList &buffers);
 
+    //! \brief Construct from a PacketBuffer (as a single view)
+    BufferViewList(const PacketBuffer &packet) : BufferViewList(packet.str()) {}
+
     //! \brief Construct from a std::string_view
     BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
     //!@}
@@ -125,6 +210,13 @@ class BufferViewList {
     //! \note used for system calls that write discontiguous buffers,
     //! e.g. [writev(2)](\ref man2::writev) and [sendmsg(2)](\ref man2::sendmsg)
     std::vector<iovec> as_iovecs() const;
+
+    //! \brief Fill `iovecs` with up to `max` `iovec` structures, without allocating
+    //! \returns the number filled in (fewer than iovec_count() if `max` is too small)
+    size_t as_iovecs(iovec *iovecs, const size_t max) const;
+
+    //! \brief Number of `iovec` structures needed to describe the string
+    size_t iovec_count() const { return _views.size(); }
 };
 
 #endif  // SPONGE_LIBSPONGE_BUFFER_HH
@@ -0,0 +1,139 @@
+#include "buffer_storage.hh"
+
+#include "huge_page_arena.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#define POISON(addr, size) ASAN_POISON_MEMORY_REGION(addr, size)
+#define UNPOISON(addr, size) ASAN_UNPOISON_MEMORY_REGION(addr, size)
+#else
+#define POISON(addr, size) static_cast<void>(0)
+#define UNPOISON(addr, size) static_cast<void>(0)
+#endif
+
+using namespace std;
+
+namespace {
+
+constexpr array<size_t, BufferPool::SIZE_CLASSES> CLASS_BYTES{256, 2048, 16 * 1024, BufferPool::MAX_BLOCK};
+
+//! Bytes taken by a block of `size_class`: the header, then the data, rounded up to a cache line
+constexpr size_t block_bytes(const size_t size_class) {
+    return (sizeof(BufferStorage) + CLASS_BYTES[size_class] + 63) / 64 * 64;
+}
+
+//! A free block (the memory of a BufferStorage that is not constructed)
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+//! Each thread's free lists and counters
+struct ThreadPool {
+    array<FreeBlock *, BufferPool::SIZE_CLASSES> free{};
+    BufferPool::Stats stats{};
+};
+
+thread_local ThreadPool pool{};
+
+//! Every slab ever allocated, so that they stay reachable (for leak checkers); never freed
+mutex slabs_mutex{};
+vector<void *> *slabs = new vector<void *>;
+
+//! Where new slabs come from, if not the heap
+atomic<HugePageArena *> arena{nullptr};
+
+//! Allocate a slab of blocks of `size_class` and put them on this thread's free list
+void refill(const size_t size_class) {
+    const size_t bytes = block_bytes(size_class);
+    const size_t count = max<size_t>(1, BufferPool::SLAB_BYTES / bytes);
+    HugePageArena *const from = arena.load(memory_order_acquire);
+    auto *slab = static_cast<char *>(from ? from->allocate(count * bytes, 64)
+                                          : ::operator new(count * bytes, align_val_t{64}));
+    {
+        const lock_guard<mutex> lock{slabs_mutex};
+        slabs->push_back(slab);
+    }
+    for (size_t i = count; i-- > 0;) {
+        auto *block = reinterpret_cast<FreeBlock *>(slab + i * bytes);
+        block->next = pool.free[size_class];
+        pool.free[size_class] = block;
+        POISON(slab + i * bytes + sizeof(FreeBlock), bytes - sizeof(FreeBlock));
+    }
+    pool.stats.slabs++;
+}
+
+}  // namespace
+
+bool &BufferStorage::thread_confined() {
+    thread_local bool confined = false;
+    return confined;
+}
+
+void BufferStorage::wrong_thread() noexcept {
+    cerr << "BufferStorage: storage confined to one thread was shared with another\n";
+    abort();
+}
+
+void BufferStorage::destroy() {
+    if (_size_class == ADOPTED) {
+        delete this;
+    } else if (_size_class == UNPOOLED) {
+        this->~BufferStorage();
+        ::operator delete(this);
+    } else {
+        BufferPool::release(this);
+    }
+}
+
+//! \param[in] size the number of bytes needed
+//! \returns storage of exactly `size` bytes, whose contents are for the caller to fill in
+BufferStorage::Ptr BufferPool::allocate(const size_t size) {
+    const auto it = lower_bound(CLASS_BYTES.begin(), CLASS_BYTES.end(), size);
+    if (it == CLASS_BYTES.end()) {
+        pool.stats.misses++;
+        void *mem = ::operator new(sizeof(BufferStorage) + size);
+        auto *data = static_cast<char *>(mem) + sizeof(BufferStorage);
+        return BufferStorage::Ptr{new (mem) BufferStorage(data, size, BufferStorage::UNPOOLED)};
+    }
+
+    const auto size_class = static_cast<uint8_t>(it - CLASS_BYTES.begin());
+    if (pool.free[size_class]) {
+        pool.stats.hits++;
+    } else {
+        pool.stats.misses++;
+        refill(size_class);
+    }
+    FreeBlock *block = pool.free[size_class];
+    UNPOISON(reinterpret_cast<char *>(block) + sizeof(FreeBlock), block_bytes(size_class) - sizeof(FreeBlock));
+    pool.free[size_class] = block->next;
+    pool.stats.in_use++;
+    pool.stats.high_water = max(pool.stats.high_water, pool.stats.in_use);
+
+    auto *data = reinterpret_cast<char *>(block) + sizeof(BufferStorage);
+    return BufferStorage::Ptr{new (block) BufferStorage(data, size, size_class)};
+}
+
+void BufferPool::release(BufferStorage *storage) {
+    const uint8_t size_class = storage->_size_class;
+    storage->~BufferStorage();
+    auto *block = reinterpret_cast<FreeBlock *>(storage);
+    block->next = pool.free[size_class];
+    pool.free[size_class] = block;
+    POISON(reinterpret_cast<char *>(block) + sizeof(FreeBlock), block_bytes(size_class) - sizeof(FreeBlock));
+    pool.stats.in_use--;
+}
+
+const BufferPool::Stats &BufferPool::stats() { return pool.stats; }
+
+size_t BufferPool::block_size(const size_t size_class) { return CLASS_BYTES.at(size_class); }
+
+void BufferPool::set_arena(HugePageArena *const new_arena) { arena.store(new_arena, memory_order_release); }
@@ -0,0 +1,204 @@
+#ifndef SPONGE_LIBSPONGE_BUFFER_STORAGE_HH
+#define SPONGE_LIBSPONGE_BUFFER_STORAGE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+
+class HugePageArena;
+
+//! \brief The reference-counted bytes behind a Buffer or PacketBuffer
+//!
+//! The reference count is intrusive, so a Buffer costs one allocation (or none, from the BufferPool)
+//! rather than the two of a `std::make_shared<std::string>`. Storage either adopts a `std::string`
+//! (when a Buffer is made from one) or is a block from the BufferPool with the bytes right after
+//! this header. The bytes may be written until the storage is shared, and are read-only after.
+//!
+//! Storage created by a thread that has called confine_to_this_thread() is counted with plain loads and
+//! stores instead of atomic read-modify-writes, for an event loop that never hands its Buffers to another
+//! thread. Builds without `NDEBUG` check that such storage is only ever counted by the thread that made it.
+class BufferStorage {
+  public:
+    //! \brief A counted reference to a BufferStorage (like a `std::shared_ptr`)
+    class Ptr {
+        BufferStorage *_storage{nullptr};
+
+      public:
+        Ptr() = default;
+
+        //! Take over the reference held by a newly created `storage`
+        explicit Ptr(BufferStorage *storage) noexcept : _storage(storage) {}
+
+        Ptr(const Ptr &other) noexcept : _storage(other._storage) {
+            if (_storage) {
+                _storage->add_ref();
+            }
+        }
+        Ptr(Ptr &&other) noexcept : _storage(std::exchange(other._storage, nullptr)) {}
+        Ptr &operator=(Ptr other) noexcept {
+            std::swap(_storage, other._storage);
+            return *this;
+        }
+        ~Ptr() { reset(); }
+
+        //! Drop the reference (freeing the storage if it was the last)
+        void reset() noexcept {
+            if (_storage && _storage->drop_ref()) {
+                _storage->destroy();
+            }
+            _storage = nullptr;
+        }
+
+        BufferStorage *get() const { return _storage; }
+        BufferStorage *operator->() const { return _storage; }
+        BufferStorage &operator*() const { return *_storage; }
+        explicit operator bool() const { return _storage != nullptr; }
+
+        //! Number of references to the storage (0 if none)
+        size_t use_count() const { return _storage ? _storage->_refs.load(std::memory_order_relaxed) : 0; }
+    };
+
+    static constexpr uint8_t ADOPTED = 0xff;   //!< _size_class of storage that adopted a std::string
+    static constexpr uint8_t UNPOOLED = 0xfe;  //!< _size_class of a block too large for the pool
+
+  private:
+    friend class BufferPool;
+
+    std::atomic<size_t> _refs{1};  //!< only ever loaded and stored (not atomically updated) if _confined
+    char *_data;
+    size_t _size;
+    uint8_t _size_class;
+    bool _confined;
+    std::string _string{};  //!< the adopted string, if any
+#ifndef NDEBUG
+    std::thread::id _owner{std::this_thread::get_id()};  //!< the thread that created the storage
+#endif
+
+    //! Whether storage created by the calling thread is confined to it
+    static bool &thread_confined();
+
+    BufferStorage(char *data, const size_t size, const uint8_t size_class)
+        : _data(data), _size(size), _size_class(size_class), _confined(thread_confined()) {}
+
+    explicit BufferStorage(std::string &&str)
+        : _data(nullptr)
+        , _size(str.size())
+        , _size_class(ADOPTED)
+        , _confined(thread_confined())
+        , _string(std::move(str)) {
+        _data = _string.data();
+    }
+
+    //! Abort, reporting confined storage counted by a thread other than its owner
+    [[noreturn]] static void wrong_thread() noexcept;
+
+    void check_owner() const noexcept {
+#ifndef NDEBUG
+        if (std::this_thread::get_id() != _owner) {
+            wrong_thread();
+        }
+#endif
+    }
+
+    void add_ref() noexcept {
+        if (_confined) {
+            check_owner();
+            _refs.store(_refs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            _refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //! Drop a reference, returning whether it was the last
+    bool drop_ref() noexcept {
+        if (_confined) {
+            check_owner();
+            const size_t refs = _refs.load(std::memory_order_relaxed) - 1;
+            _refs.store(refs, std::memory_order_relaxed);
+            return refs == 0;
+        }
+        return _refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    //! Free the storage (its last reference has gone)
+    void destroy();
+
+  public:
+    BufferStorage(const BufferStorage &other) = delete;
+    BufferStorage &operator=(const BufferStorage &other) = delete;
+    ~BufferStorage() = default;
+
+    //! \brief Storage that takes ownership of `str` (without copying its bytes)
+    static Ptr adopt(std::string &&str) { return Ptr{new BufferStorage(std::move(str))}; }
+
+    //! \name The bytes
+    //!@{
+    char *data() { return _data; }
+    const char *data() const { return _data; }
+    size_t size() const { return _size; }
+    //!@}
+
+    //! \brief Is this a block from the BufferPool?
+    bool pooled() const { return _size_class != ADOPTED && _size_class != UNPOOLED; }
+
+    //! \brief Is this storage confined to the thread that created it?
+    bool confined() const { return _confined; }
+
+    //! \brief Confine (or stop confining) the storage that the calling thread creates from now on to that thread
+    //! \details The thread must not share Buffers, BufferLists or TCPSegments made while confined with
+    //! another thread, nor let them outlive it.
+    static void confine_to_this_thread(const bool confine = true) { thread_confined() = confine; }
+};
+
+//! \brief Size-classed slabs of blocks for BufferStorage, recycled through per-thread free lists
+//!
+//! A block holds a BufferStorage header and up to 256 bytes, 2 KiB (an MTU-sized packet with headroom
+//! for its headers), 16 KiB or 64 KiB. Blocks are carved from 256 KiB slabs; a freed block goes on
+//! the free list of the thread that frees it, from which that thread's next allocation of the same
+//! class takes it without locking or calling the allocator. Slabs are never returned to the system
+//! (and blocks left on the free list of a thread that exits are not reused).
+//! Anything larger than 64 KiB is allocated (and freed) on its own.
+//!
+//! Slabs come from the heap, or from a HugePageArena passed to set_arena().
+//!
+//! In builds with AddressSanitizer, free blocks are poisoned, so that a use after free still faults.
+class BufferPool {
+  public:
+    static constexpr size_t SIZE_CLASSES = 4;         //!< number of block sizes
+    static constexpr size_t SLAB_BYTES = 256 * 1024;  //!< bytes allocated at a time for each class
+    static constexpr size_t MAX_BLOCK = 64 * 1024;    //!< largest block, in bytes of data
+
+    //! \brief Counters describing the calling thread's use of the pool
+    struct Stats {
+        size_t hits{0};           //!< allocations served from a free list
+        size_t misses{0};         //!< allocations that needed a new slab, or were too large for the pool
+        ptrdiff_t in_use{0};      //!< pooled blocks allocated, less those freed, by this thread
+        ptrdiff_t high_water{0};  //!< highest value of in_use
+        size_t slabs{0};          //!< slabs allocated
+    };
+
+    //! \brief Storage for `size` bytes (uninitialized), from the pool if it is small enough
+    static BufferStorage::Ptr allocate(const size_t size);
+
+    //! \brief The calling thread's counters
+    static const Stats &stats();
+
+    //! \brief The data capacity of blocks of size class `size_class`
+    static size_t block_size(const size_t size_class);
+
+    //! \brief Take new slabs from `arena` (or from the heap, if null), in every thread
+    //! \details Slabs already allocated stay where they are. The arena must outlive every block from it,
+    //! which in practice means it must never be destroyed.
+    static void set_arena(HugePageArena *arena);
+
+  private:
+    friend class BufferStorage;
+
+    //! Return a pooled block to the calling thread's free list
+    static void release(BufferStorage *storage);
+};
+
+#endif  // SPONGE_LIBSPONGE_BUFFER_STORAGE_HH
@@ -0,0 +1,264 @@
+#include "checksum.hh"
+
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SPONGE_HAVE_X86_SIMD 1
+#endif
+
+using namespace std;
+
+namespace {
+
+constexpr bool little_endian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+//! Fold a 64-bit one's-complement sum to 16 bits (never 0 unless `sum` is)
+uint16_t fold(uint64_t sum) {
+    sum = (sum & 0xffff'ffff) + (sum >> 32);
+    sum = (sum & 0xffff'ffff) + (sum >> 32);
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(sum);
+}
+
+//! Convert a folded sum of native-order words to the sum of big-endian words
+uint16_t to_network_order(const uint16_t sum) {
+    return little_endian ? static_cast<uint16_t>((sum << 8) | (sum >> 8)) : sum;
+}
+
+//! \name Kernels
+//! Each kernel sums `len` bytes at `src`; with `Copy`, it also stores them to `dst` as it goes.
+//!@{
+
+//! Sum (and copy) the last `len` (< 8) bytes, as a native-order word padded with zeros
+template <bool Copy>
+uint16_t tail(uint8_t *dst, const uint8_t *src, const size_t len) {
+    if (len == 0) {
+        return 0;  // `src` (and `dst`) may be null
+    }
+    uint64_t word = 0;
+    memcpy(&word, src, len);
+    if constexpr (Copy) {
+        memcpy(dst, src, len);
+    }
+    return fold(word);
+}
+
+//! Sum (and copy) the bytes from `i` on, which are fewer than a vector, and add them to `sum`
+template <bool Copy>
+uint16_t finish(uint64_t sum, uint8_t *dst, const uint8_t *src, size_t i, const size_t len) {
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+        if constexpr (Copy) {
+            memcpy(dst + i, &word, sizeof(word));
+        }
+        sum += fold(word);
+    }
+    if constexpr (Copy) {
+        sum += tail<Copy>(dst + i, src + i, len - i);
+    } else {
+        sum += tail<Copy>(nullptr, src + i, len - i);  // `dst` is null
+    }
+    return to_network_order(fold(sum));
+}
+
+template <bool Copy>
+uint16_t sum_bytewise(uint8_t *dst, const uint8_t *src, const size_t len) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += (i % 2 == 0) ? uint64_t{src[i]} << 8 : src[i];
+        if constexpr (Copy) {
+            dst[i] = src[i];
+        }
+    }
+    return fold(sum);
+}
+
+//! \details Four independent accumulators hide the latency of the carry chain.
+template <bool Copy>
+uint16_t sum_words(uint8_t *dst, const uint8_t *src, const size_t len) {
+    uint64_t acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            memcpy(&word, src + i + 8 * lane, sizeof(word));
+            if constexpr (Copy) {
+                memcpy(dst + i + 8 * lane, &word, sizeof(word));
+            }
+            acc[lane] += word;
+            acc[lane] += acc[lane] < word;  // end-around carry
+        }
+    }
+    uint64_t sum = 0;
+    for (const uint64_t a : acc) {
+        sum += fold(a);
+    }
+    return finish<Copy>(sum, dst, src, i, len);
+}
+
+#ifdef SPONGE_HAVE_X86_SIMD
+//! Vectors summed into 32-bit lanes before they are widened (keeps each lane within 2^29 in magnitude)
+constexpr size_t SIMD_BLOCK = 8192;
+
+//! \details `pmaddwd` against a vector of ones adds adjacent 16-bit lanes into 32-bit lanes, but treats
+//! them as signed. Flipping each word's top bit first subtracts 32768 from it, which is added back
+//! (65536 per 32-bit lane per vector) when the lanes are widened.
+template <bool Copy>
+__attribute__((target("sse2"))) uint16_t sum_sse2(uint8_t *dst, const uint8_t *src, const size_t len) {
+    const __m128i bias = _mm_set1_epi16(-0x8000);
+    const __m128i ones = _mm_set1_epi16(1);
+    uint64_t sum = 0;
+    size_t i = 0;
+    while (i + 32 <= len) {
+        __m128i acc0 = _mm_setzero_si128();
+        __m128i acc1 = _mm_setzero_si128();
+        size_t vectors = 0;
+        for (; i + 32 <= len && vectors < SIMD_BLOCK; i += 32, vectors++) {
+            const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16));
+            if constexpr (Copy) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v0);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16), v1);
+            }
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_xor_si128(v0, bias), ones));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_xor_si128(v1, bias), ones));
+        }
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_add_epi32(acc0, acc1));
+        int64_t block = 0;
+        for (const int32_t lane : lanes) {
+            block += lane;
+        }
+        sum += static_cast<uint64_t>(block + static_cast<int64_t>(vectors) * 2 * 4 * 65536);
+    }
+    return finish<Copy>(sum, dst, src, i, len);
+}
+
+//! \details As sum_sse2(), with 32-byte vectors.
+template <bool Copy>
+__attribute__((target("avx2"))) uint16_t sum_avx2(uint8_t *dst, const uint8_t *src, const size_t len) {
+    const __m256i bias = _mm256_set1_epi16(-0x8000);
+    const __m256i ones = _mm256_set1_epi16(1);
+    uint64_t sum = 0;
+    size_t i = 0;
+    while (i + 64 <= len) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        size_t vectors = 0;
+        for (; i + 64 <= len && vectors < SIMD_BLOCK; i += 64, vectors++) {
+            const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+            if constexpr (Copy) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v0);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), v1);
+            }
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_xor_si256(v0, bias), ones));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_xor_si256(v1, bias), ones));
+        }
+        alignas(32) int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), _mm256_add_epi32(acc0, acc1));
+        int64_t block = 0;
+        for (const int32_t lane : lanes) {
+            block += lane;
+        }
+        sum += static_cast<uint64_t>(block + static_cast<int64_t>(vectors) * 2 * 8 * 65536);
+    }
+    return finish<Copy>(sum, dst, src, i, len);
+}
+#endif
+//!@}
+
+using KernelFn = uint16_t (*)(uint8_t *, const uint8_t *, size_t);
+
+template <bool Copy>
+KernelFn kernel(const ChecksumKernel::Variant variant) {
+    switch (variant) {
+        case ChecksumKernel::Variant::Bytewise:
+            return sum_bytewise<Copy>;
+        case ChecksumKernel::Variant::Word:
+            return sum_words<Copy>;
+#ifdef SPONGE_HAVE_X86_SIMD
+        case ChecksumKernel::Variant::SSE2:
+            return sum_sse2<Copy>;
+        case ChecksumKernel::Variant::AVX2:
+            return sum_avx2<Copy>;
+#endif
+        default:
+            return sum_words<Copy>;
+    }
+}
+
+}  // namespace
+
+//! \param[in] data the bytes to sum
+//! \param[in] len how many
+//! \returns the folded one's-complement sum of the big-endian 16-bit words of `data`
+uint16_t ChecksumKernel::sum(const uint8_t *data, const size_t len) {
+    static const KernelFn best_kernel = kernel<false>(best());
+    return best_kernel(nullptr, data, len);
+}
+
+uint16_t ChecksumKernel::sum(const Variant variant, const uint8_t *data, const size_t len) {
+    return kernel<false>(variant)(nullptr, data, len);
+}
+
+//! \param[out] dst where to copy the bytes (must not overlap `src`)
+//! \param[in] src the bytes to copy and sum
+//! \param[in] len how many
+//! \returns the folded one's-complement sum of the big-endian 16-bit words of `src`
+//! \details Each word is summed while it is in a register on its way to `dst`, so the source is read once,
+//! instead of once by `memcpy` and again by sum().
+uint16_t ChecksumKernel::copy_and_sum(uint8_t *dst, const uint8_t *src, const size_t len) {
+    static const KernelFn best_kernel = kernel<true>(best());
+    return best_kernel(dst, src, len);
+}
+
+uint16_t ChecksumKernel::copy_and_sum(const Variant variant, uint8_t *dst, const uint8_t *src, const size_t len) {
+    return kernel<true>(variant)(dst, src, len);
+}
+
+//! \details The SIMD variants are chosen with `__builtin_cpu_supports`, so that one binary runs
+//! anywhere and uses AVX2 where it exists.
+bool ChecksumKernel::supported(const Variant variant) {
+    switch (variant) {
+        case Variant::Bytewise:
+        case Variant::Word:
+            return true;
+#ifdef SPONGE_HAVE_X86_SIMD
+        case Variant::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Variant::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+ChecksumKernel::Variant ChecksumKernel::best() {
+    for (const Variant variant : {Variant::AVX2, Variant::SSE2}) {
+        if (supported(variant)) {
+            return variant;
+        }
+    }
+    return Variant::Word;
+}
+
+const char *ChecksumKernel::name(const Variant variant) {
+    switch (variant) {
+        case Variant::Bytewise:
+            return "bytewise";
+        case Variant::Word:
+            return "64-bit words";
+        case Variant::SSE2:
+            return "SSE2";
+        case Variant::AVX2:
+            return "AVX2";
+    }
+    return "unknown";
+}
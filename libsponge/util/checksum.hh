@@ -0,0 +1,53 @@
+#ifndef SPONGE_LIBSPONGE_CHECKSUM_HH
+#define SPONGE_LIBSPONGE_CHECKSUM_HH
+
+#include <cstddef>
+#include <cstdint>
+
+//! \brief Kernels computing the 16-bit one's-complement sum that underlies the Internet checksum
+//!
+//! Each kernel returns the sum of `data` taken as big-endian 16-bit words (a final odd byte is the
+//! high byte of a word), folded to 16 bits but not complemented; the sum of a non-empty buffer
+//! that is not all zeros is never 0. InternetChecksum calls sum(), which uses the fastest kernel
+//! this CPU supports; the copy_and_sum() kernels also copy the bytes as they sum them.
+//!
+//! The sum can be taken in any byte order and swapped at the end, so the kernels add whole
+//! machine words (with end-around carry) or vectors and do not swap bytes until the final fold.
+class ChecksumKernel {
+  public:
+    //! The available implementations
+    enum class Variant {
+        Bytewise,  //!< one byte per iteration (the reference)
+        Word,      //!< 64-bit words with end-around carry
+        SSE2,      //!< 16 bytes per iteration, with SSE2
+        AVX2       //!< 32 bytes per iteration, with AVX2
+    };
+
+    //! \brief The one's-complement sum of `len` bytes at `data`, using the best supported variant
+    static uint16_t sum(const uint8_t *data, const size_t len);
+
+    //! \brief The one's-complement sum of `len` bytes at `data`, using `variant`
+    //! \note `variant` must be supported()
+    static uint16_t sum(const Variant variant, const uint8_t *data, const size_t len);
+
+    //! \brief Copy `len` bytes from `src` to `dst` and return their sum, in one pass
+    static uint16_t copy_and_sum(uint8_t *dst, const uint8_t *src, const size_t len);
+
+    //! \brief Copy `len` bytes from `src` to `dst` and return their sum, using `variant`
+    //! \note `variant` must be supported()
+    static uint16_t copy_and_sum(const Variant variant, uint8_t *dst, const uint8_t *src, const size_t len);
+
+    //! \brief Are `a` and `b` the same one's-complement sum? (0x0000 and 0xffff are both zero.)
+    static bool equal(const uint16_t a, const uint16_t b) { return a % 0xffff == b % 0xffff; }
+
+    //! \brief Can this CPU run `variant`?
+    static bool supported(const Variant variant);
+
+    //! \brief The variant that sum() uses
+    static Variant best();
+
+    //! \brief The name of `variant`
+    static const char *name(const Variant variant);
+};
+
+#endif  // SPONGE_LIBSPONGE_CHECKSUM_HH
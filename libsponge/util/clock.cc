@@ -0,0 +1,106 @@
+#include "clock.hh"
+
+#include "util.hh"
+
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define SPONGE_HAVE_TSC 1
+#endif
+
+using namespace std;
+
+namespace {
+
+uint64_t read_clock(const clockid_t id) {
+    timespec ts{};
+    SystemCall("clock_gettime", ::clock_gettime(id, &ts));
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+//! A (counter, time) pair and the counter's rate, measured once
+struct TSCCalibration {
+    uint64_t base_ticks{0};   //!< the counter at base_ns
+    uint64_t base_ns{0};      //!< CLOCK_MONOTONIC at base_ticks
+    double ns_per_tick{0.0};  //!< the counter's period
+};
+
+//! \details Samples the counter and CLOCK_MONOTONIC together at both ends of a 10 ms busy-wait. Each
+//! sample brackets the clock read between two counter reads and keeps the tightest of a few tries.
+const TSCCalibration &calibration() {
+    static const TSCCalibration cal = [] {
+        TSCCalibration c{};
+        if (not TSC::available()) {
+            return c;
+        }
+        const auto sample = [](uint64_t &ticks, uint64_t &ns) {
+            uint64_t best = UINT64_MAX;
+            for (unsigned i = 0; i < 5; i++) {
+                const uint64_t before = TSC::ticks();
+                const uint64_t now = Clock::monotonic_ns();
+                const uint64_t after = TSC::ticks();
+                if (after - before < best) {
+                    best = after - before;
+                    ticks = before + (after - before) / 2;
+                    ns = now;
+                }
+            }
+        };
+        sample(c.base_ticks, c.base_ns);
+        while (Clock::monotonic_ns() < c.base_ns + 10'000'000) {
+        }
+        uint64_t end_ticks = 0;
+        uint64_t end_ns = 0;
+        sample(end_ticks, end_ns);
+        c.ns_per_tick = static_cast<double>(end_ns - c.base_ns) / static_cast<double>(end_ticks - c.base_ticks);
+        return c;
+    }();
+    return cal;
+}
+
+}  // namespace
+
+uint64_t Clock::monotonic_ns() { return read_clock(CLOCK_MONOTONIC); }
+
+uint64_t Clock::coarse_ns() { return read_clock(CLOCK_MONOTONIC_COARSE); }
+
+uint64_t Clock::coarse_resolution_ns() {
+    timespec res{};
+    SystemCall("clock_getres", ::clock_getres(CLOCK_MONOTONIC_COARSE, &res));
+    return static_cast<uint64_t>(res.tv_sec) * 1'000'000'000 + static_cast<uint64_t>(res.tv_nsec);
+}
+
+//! \details Checks the "invariant TSC" bit of CPUID leaf 0x80000007.
+bool TSC::available() {
+#ifdef SPONGE_HAVE_TSC
+    static const bool invariant = [] {
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) != 0 && (edx & (1U << 8)) != 0;
+    }();
+    return invariant;
+#else
+    return false;
+#endif
+}
+
+uint64_t TSC::ticks() {
+#ifdef SPONGE_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+double TSC::ns_per_tick() { return calibration().ns_per_tick; }
+
+//! \note The conversion uses a double, which keeps nanosecond precision for about a month of ticks
+//! after calibration at 3 GHz.
+uint64_t TSC::ns() {
+    if (not available()) {
+        return Clock::monotonic_ns();
+    }
+    const TSCCalibration &cal = calibration();
+    return cal.base_ns + static_cast<uint64_t>(static_cast<double>(ticks() - cal.base_ticks) * cal.ns_per_tick);
+}
@@ -0,0 +1,77 @@
+#ifndef SPONGE_LIBSPONGE_CLOCK_HH
+#define SPONGE_LIBSPONGE_CLOCK_HH
+
+#include <cstdint>
+
+//! \brief Clock sources for timestamps on the hot path, all in nanoseconds of `CLOCK_MONOTONIC`
+//!
+//! - monotonic_ns() reads [clock_gettime(2)](\ref man2::clock_gettime) (a vDSO call, no syscall).
+//! - coarse_ns() reads `CLOCK_MONOTONIC_COARSE`: cheaper still, but only as fine as the kernel's
+//!   tick (coarse_resolution_ns(), typically 1–4 ms).
+//! - now_ns() is the time cached for the current event-loop iteration: EventLoop takes one reading
+//!   when [poll(2)](\ref man2::poll) returns, and every timestamp taken by the callbacks it then runs
+//!   costs a thread-local load. Outside an iteration, it falls back to monotonic_ns().
+class Clock {
+    inline static thread_local uint64_t _cached_ns{0};  //!< the time the current iteration began
+    inline static thread_local bool _cached{false};     //!< is an iteration in progress?
+
+  public:
+    //! \brief Marks one iteration of an event loop, for as long as the object lives
+    //! \details Iterations may nest; the inner one's time applies until it ends.
+    class Iteration {
+        uint64_t _outer_ns;  //!< cached time of the enclosing iteration
+        bool _outer;         //!< was an iteration already in progress?
+
+      public:
+        //! Read the clock and cache the reading
+        Iteration() : _outer_ns(_cached_ns), _outer(_cached) {
+            _cached_ns = monotonic_ns();
+            _cached = true;
+        }
+        ~Iteration() {
+            _cached_ns = _outer_ns;
+            _cached = _outer;
+        }
+
+        Iteration(const Iteration &other) = delete;
+        Iteration &operator=(const Iteration &other) = delete;
+    };
+
+    //! \brief CLOCK_MONOTONIC, read now
+    static uint64_t monotonic_ns();
+
+    //! \brief CLOCK_MONOTONIC_COARSE, as of the kernel's last tick
+    static uint64_t coarse_ns();
+
+    //! \brief The resolution of coarse_ns()
+    static uint64_t coarse_resolution_ns();
+
+    //! \brief The time the current event-loop iteration began (or monotonic_ns(), outside one)
+    static uint64_t now_ns() { return _cached ? _cached_ns : monotonic_ns(); }
+
+    //! \brief Is an event-loop iteration in progress (i.e., is now_ns() cached)?
+    static bool cached() { return _cached; }
+};
+
+//! \brief The CPU's time-stamp counter, calibrated against Clock::monotonic_ns()
+//!
+//! On x86 processors with an invariant TSC (one that ticks at a constant rate in every power state
+//! and on every core), `rdtsc` is the cheapest clock there is. The first call to ns() or
+//! ns_per_tick() calibrates the counter against `CLOCK_MONOTONIC` over about 10 ms. Elsewhere,
+//! available() is `false` and ns() falls back to Clock::monotonic_ns().
+class TSC {
+  public:
+    //! \brief Does this CPU have an invariant TSC?
+    static bool available();
+
+    //! \brief The raw counter (0 if not available())
+    static uint64_t ticks();
+
+    //! \brief Nanoseconds per tick, as calibrated
+    static double ns_per_tick();
+
+    //! \brief The counter converted to CLOCK_MONOTONIC nanoseconds
+    static uint64_t ns();
+};
+
+#endif  // SPONGE_LIBSPONGE_CLOCK_HH
@@ -1,5 +1,6 @@
 #include "eventloop.hh"
 
+#include "clock.hh"
 #include "util.hh"
 
 #include <cerrno>
@@ -39,7 +40,8 @@ void EventLoop::add_rule(const FileDescriptor &fd,
 //!
 //! Next, this function calls [poll(2)](\ref man2::poll) with timeout value `timeout_ms`.
 //!
-//! Then, for each ready file descriptor, this function calls Rule::callback. If fd reaches EOF or
+//! Then, for each ready file descriptor, this function calls Rule::callback. During the callbacks,
+//! Clock::now_ns() (and timestamp_ms()) return the time at which poll returned. If fd reaches EOF or
 //! if the Rule was registered using EventLoop::add_cancelable_rule and Rule::callback returns true,
 //! this Rule is canceled.
 //!
@@ -104,6 +106,9 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
         }
     }
 
+    // every callback run for this iteration sees the time poll returned
+    const Clock::Iteration iteration{};
+
     // go through the poll results
 
     for (auto [it, idx] = make_pair(_rules.begin(), size_t(0)); it != _rules.end(); ++idx) {
@@ -49,6 +49,9 @@ class FileDescriptor {
     void register_write() { ++_internal_fd->_write_count; }  //!< increment write count
 
   public:
+    //! Most `iovec`s passed to one [writev(2)](\ref man2::writev), from an array on the stack
+    static constexpr size_t IOV_BATCH = 64;
+
     //! Construct from a file descriptor number returned by the kernel
     explicit FileDescriptor(const int fd);
 
@@ -0,0 +1,97 @@
+#include "huge_page_arena.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/mman.h>
+
+using namespace std;
+
+//! \param[in] bytes the smallest chunk that will do
+//! \details A chunk not backed by reserved huge pages is mapped a huge page larger than needed, and trimmed to
+//! start on a huge-page boundary, since transparent huge pages only back whole, aligned huge pages.
+void HugePageArena::map_chunk(const size_t bytes) {
+    const size_t size = (max(bytes, _chunk_bytes) + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    constexpr int prot = PROT_READ | PROT_WRITE;
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    void *base = MAP_FAILED;
+    Backing backing = Backing::HugeTLB;
+    if (_try_hugetlb) {
+        base = mmap(nullptr, size, prot, flags | MAP_HUGETLB, -1, 0);
+    }
+    if (base == MAP_FAILED) {
+        void *raw = mmap(nullptr, size + HUGE_PAGE, prot, flags, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw unix_error("mmap");
+        }
+        const auto start = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (start + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        if (aligned > start) {
+            munmap(raw, aligned - start);
+        }
+        if (const size_t tail = start + HUGE_PAGE - aligned; tail > 0) {
+            munmap(reinterpret_cast<void *>(aligned + size), tail);
+        }
+        base = reinterpret_cast<void *>(aligned);
+        backing = madvise(base, size, MADV_HUGEPAGE) == 0 ? Backing::Transparent : Backing::Small;
+    }
+
+    _chunks.push_back({base, size, backing});
+    _next = static_cast<char *>(base);
+    _end = _next + size;
+    _stats.chunks++;
+    _stats.hugetlb += backing == Backing::HugeTLB;
+    _stats.transparent += backing == Backing::Transparent;
+    _stats.mapped += size;
+}
+
+HugePageArena::HugePageArena(const size_t chunk_bytes, const bool try_hugetlb)
+    : _chunk_bytes(chunk_bytes), _try_hugetlb(try_hugetlb) {}
+
+HugePageArena::~HugePageArena() {
+    for (const auto &chunk : _chunks) {
+        munmap(chunk.base, chunk.size);
+    }
+}
+
+//! \param[in] bytes the size of the allocation
+//! \param[in] alignment the alignment of its first byte
+//! \details The rest of the current chunk is abandoned if the allocation does not fit in it.
+void *HugePageArena::allocate(const size_t bytes, const size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > HUGE_PAGE) {
+        throw invalid_argument("HugePageArena::allocate: bad alignment");
+    }
+    const lock_guard<mutex> lock{_mutex};
+    auto aligned = [&] {
+        const auto next = reinterpret_cast<uintptr_t>(_next);
+        return reinterpret_cast<char *>((next + alignment - 1) & ~(alignment - 1));
+    };
+    if (not _next || bytes > static_cast<size_t>(_end - aligned())) {
+        map_chunk(bytes);
+    }
+    char *ret = aligned();
+    _next = ret + bytes;
+    _stats.allocated += bytes;
+    return ret;
+}
+
+//! \param[in] ptr memory allocated from the arena
+HugePageArena::Backing HugePageArena::backing(const void *ptr) {
+    const lock_guard<mutex> lock{_mutex};
+    const auto *p = static_cast<const char *>(ptr);
+    for (const auto &chunk : _chunks) {
+        const auto *base = static_cast<const char *>(chunk.base);
+        if (p >= base && p < base + chunk.size) {
+            return chunk.backing;
+        }
+    }
+    throw invalid_argument("HugePageArena::backing: not from this arena");
+}
+
+HugePageArena::Stats HugePageArena::stats() {
+    const lock_guard<mutex> lock{_mutex};
+    return _stats;
+}
@@ -0,0 +1,76 @@
+#ifndef SPONGE_LIBSPONGE_HUGE_PAGE_ARENA_HH
+#define SPONGE_LIBSPONGE_HUGE_PAGE_ARENA_HH
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+//! \brief Memory mapped in huge pages where the system allows it, handed out by bumping a pointer
+//!
+//! Thousands of connections, each with 64 KiB of buffers, spread their bytes over more 4 KiB pages than
+//! the TLB can map. The arena maps chunks of memory with `MAP_HUGETLB` (reserved huge pages), or failing
+//! that asks for transparent huge pages with [madvise(2)](\ref man2::madvise), or failing that settles for
+//! ordinary pages (see [mmap(2)](\ref man2::mmap)). Allocations are never freed individually, so the
+//! arena suits callers that recycle what they allocate, like the slabs of the BufferPool (see
+//! BufferPool::set_arena()), which hold the BlockBuffer%s of ByteStream and StreamReassembler as well
+//! as packets. Everything is unmapped when the arena is destroyed.
+class HugePageArena {
+  public:
+    static constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;     //!< size of a huge page (on x86-64)
+    static constexpr size_t DEFAULT_CHUNK = 16 * HUGE_PAGE;  //!< bytes mapped at a time, by default
+
+    //! \brief How a chunk is backed
+    enum class Backing { HugeTLB, Transparent, Small };
+
+    //! \brief Counters describing the arena's mappings
+    struct Stats {
+        size_t chunks{0};       //!< chunks mapped
+        size_t hugetlb{0};      //!< chunks backed by reserved huge pages
+        size_t transparent{0};  //!< chunks that transparent huge pages were requested for
+        size_t mapped{0};       //!< bytes mapped
+        size_t allocated{0};    //!< bytes handed out
+    };
+
+  private:
+    //! A mapped chunk
+    struct Chunk {
+        void *base;
+        size_t size;
+        Backing backing;
+    };
+
+    std::mutex _mutex{};
+    std::vector<Chunk> _chunks{};
+    char *_next{nullptr};  //!< first free byte of the current chunk
+    char *_end{nullptr};   //!< end of the current chunk
+    size_t _chunk_bytes;
+    bool _try_hugetlb;
+    Stats _stats{};
+
+    //! Map a chunk of at least `bytes`, and make it the current one
+    void map_chunk(const size_t bytes);
+
+  public:
+    //! \brief An arena that maps `chunk_bytes` (rounded up to whole huge pages) at a time
+    //! \param[in] chunk_bytes the size of each mapping
+    //! \param[in] try_hugetlb whether to ask for reserved huge pages before transparent ones
+    explicit HugePageArena(const size_t chunk_bytes = DEFAULT_CHUNK, const bool try_hugetlb = true);
+
+    HugePageArena(const HugePageArena &other) = delete;
+    HugePageArena &operator=(const HugePageArena &other) = delete;
+    ~HugePageArena();
+
+    //! \brief `bytes` of zero-filled memory, aligned to `alignment` (a power of two no larger than a huge page)
+    //! \note Thread-safe
+    void *allocate(const size_t bytes, const size_t alignment = 64);
+
+    //! \brief How the chunk holding `ptr` (which must come from this arena) is backed
+    //! \note For Backing::Transparent, whether the kernel has actually used huge pages shows in
+    //! the `AnonHugePages` lines of `/proc/self/smaps`
+    Backing backing(const void *ptr);
+
+    //! \brief The arena's counters
+    Stats stats();
+};
+
+#endif  // SPONGE_LIBSPONGE_HUGE_PAGE_ARENA_HH
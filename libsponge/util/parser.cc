@@ -25,23 +25,33 @@ void NetParser::_check_size(const size_t size) {
 
 template <typename T>
 T NetParser::_parse_int() {
-    constexpr size_t len = sizeof(T);
-    _check_size(len);
-    if (error()) {
+    const uint8_t *data = peek(sizeof(T));
+    if (not data) {
         return 0;
     }
 
-    T ret = 0;
-    for (size_t i = 0; i < len; i++) {
-        ret <<= 8;
-        ret += uint8_t(_buffer.at(i));
+    T ret;
+    if constexpr (sizeof(T) == 1) {
+        ret = data[0];
+    } else if constexpr (sizeof(T) == 2) {
+        ret = load_u16(data);
+    } else {
+        ret = load_u32(data);
     }
 
-    _buffer.remove_prefix(len);
+    _buffer.remove_prefix(sizeof(T));
 
     return ret;
 }
 
+const uint8_t *NetParser::peek(const size_t n) {
+    _check_size(n);
+    if (error()) {
+        return nullptr;
+    }
+    return reinterpret_cast<const uint8_t *>(_buffer.str().data());
+}
+
 void NetParser::remove_prefix(const size_t n) {
     _check_size(n);
     if (error()) {
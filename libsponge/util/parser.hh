@@ -5,6 +5,8 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <endian.h>
 #include <string>
 #include <utility>
 
@@ -60,6 +62,27 @@ class NetParser {
 
     //! Remove n bytes from the buffer
     void remove_prefix(const size_t n);
+
+    //! \brief Check (once) that `n` more bytes remain, without consuming them
+    //! \returns a pointer to the next `n` bytes, valid until they are removed; or nullptr (setting the error)
+    //! \details For parsing a fixed-size header in one go: peek() at it, decode its fields with load_u16() and
+    //! load_u32(), then remove_prefix() it.
+    const uint8_t *peek(const size_t n);
+
+    //! \name Loads of integers in network byte order from raw (possibly unaligned) bytes
+    //!@{
+    static uint16_t load_u16(const uint8_t *data) {
+        uint16_t val;
+        std::memcpy(&val, data, sizeof(val));
+        return be16toh(val);
+    }
+
+    static uint32_t load_u32(const uint8_t *data) {
+        uint32_t val;
+        std::memcpy(&val, data, sizeof(val));
+        return be32toh(val);
+    }
+    //!@}
 };
 
 struct NetUnparser {
@@ -74,6 +97,19 @@ struct NetUnparser {
 
     //! Write an 8-bit integer into the data stream in network byte order
     static void u8(std::string &s, const uint8_t val);
+
+    //! \name Stores of integers in network byte order to raw (possibly unaligned) bytes
+    //!@{
+    static void store_u16(uint8_t *data, const uint16_t val) {
+        const uint16_t be = htobe16(val);
+        std::memcpy(data, &be, sizeof(be));
+    }
+
+    static void store_u32(uint8_t *data, const uint32_t val) {
+        const uint32_t be = htobe32(val);
+        std::memcpy(data, &be, sizeof(be));
+    }
+    //!@}
 };
 
 #endif  // SPONGE_LIBSPONGE_PARSER_HH
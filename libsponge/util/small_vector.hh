@@ -0,0 +1,92 @@
+#ifndef SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+#define SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//! \brief A sequence that keeps up to `N` elements inline, and moves them all to the heap beyond that
+//!
+//! For the short lists of pieces that make up a packet (a header or two and a payload), so that building
+//! one allocates nothing. The elements are contiguous either way, so the iterators are pointers. Removing
+//! from the front shifts the rest down, which is cheap for the handful of elements this is meant for.
+//! `T` must be default-constructible; unused inline slots hold default-constructed values.
+template <typename T, size_t N>
+class SmallVector {
+    std::array<T, N> _inline{};
+    std::vector<T> _heap{};  //!< all the elements, once there have been more than N
+    size_t _size{0};         //!< number of elements while they are inline
+
+    bool on_heap() const { return not _heap.empty(); }
+
+  public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    //! \name Access
+    //!@{
+    T *data() { return on_heap() ? _heap.data() : _inline.data(); }
+    const T *data() const { return on_heap() ? _heap.data() : _inline.data(); }
+    size_t size() const { return on_heap() ? _heap.size() : _size; }
+    bool empty() const { return size() == 0; }
+
+    T &operator[](const size_t i) { return data()[i]; }
+    const T &operator[](const size_t i) const { return data()[i]; }
+    T &front() { return data()[0]; }
+    const T &front() const { return data()[0]; }
+    T &back() { return data()[size() - 1]; }
+    const T &back() const { return data()[size() - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
+    //!@}
+
+    //! \name Modifiers
+    //!@{
+    void push_back(T value) {
+        if (on_heap()) {
+            _heap.push_back(std::move(value));
+        } else if (_size < N) {
+            _inline[_size++] = std::move(value);
+        } else {
+            _heap.reserve(2 * N);
+            for (auto &x : _inline) {
+                _heap.push_back(std::exchange(x, T{}));
+            }
+            _heap.push_back(std::move(value));
+            _size = 0;
+        }
+    }
+
+    void pop_front() {
+        if (on_heap()) {
+            _heap.erase(_heap.begin());
+            return;
+        }
+        std::move(_inline.begin() + 1, _inline.begin() + _size, _inline.begin());
+        _inline[--_size] = T{};
+    }
+
+    void pop_back() {
+        if (on_heap()) {
+            _heap.pop_back();
+            return;
+        }
+        _inline[--_size] = T{};
+    }
+
+    void clear() {
+        _heap.clear();
+        for (size_t i = 0; i < _size; i++) {
+            _inline[i] = T{};
+        }
+        _size = 0;
+    }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_SMALL_VECTOR_HH
@@ -2,9 +2,11 @@
 
 #include "util.hh"
 
+#include <array>
 #include <cstddef>
 #include <stdexcept>
 #include <unistd.h>
+#include <vector>
 
 using namespace std;
 
@@ -116,13 +118,20 @@ void sendmsg_helper(const int fd_num,
                     const sockaddr *destination_address,
                     const socklen_t destination_address_len,
                     const BufferViewList &payload) {
-    auto iovecs = payload.as_iovecs();
-
+    // a datagram must go in one call, so one with more pieces than fit on the stack gets a vector
+    array<iovec, FileDescriptor::IOV_BATCH> local;
+    vector<iovec> spilled;
     msghdr message{};
     message.msg_name = const_cast<sockaddr *>(destination_address);
     message.msg_namelen = destination_address_len;
-    message.msg_iov = iovecs.data();
-    message.msg_iovlen = iovecs.size();
+    if (payload.iovec_count() <= local.size()) {
+        message.msg_iov = local.data();
+        message.msg_iovlen = payload.as_iovecs(local.data(), local.size());
+    } else {
+        spilled = payload.as_iovecs();
+        message.msg_iov = spilled.data();
+        message.msg_iovlen = spilled.size();
+    }
 
     const ssize_t bytes_sent = SystemCall("sendmsg", ::sendmsg(fd_num, &message, 0));
 
@@ -0,0 +1,142 @@
+#include "timer_wheel.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+static_assert(TimerWheel::SLOTS <= 64, "TimerWheel::_occupied has one bit per bucket");
+
+void TimerWheel::Timer::cancel() {
+    if (_wheel) {
+        _wheel->cancel(*this);
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    for (auto &level : _buckets) {
+        for (Timer *timer : level) {
+            for (; timer; timer = timer->_next) {
+                timer->_wheel = nullptr;
+            }
+        }
+    }
+}
+
+//! \param[in] timer a timer whose deadline is not in the past
+//! \details The level is the lowest one whose span covers the time left; within it, the bucket is
+//!          selected by the deadline's bits for that level, so that it cascades just in time.
+void TimerWheel::file(Timer &timer) {
+    uint64_t expires = timer._expires;
+    size_t level = 0;
+    if (expires - _now >= SPAN) {
+        // too far off: park it at the far end of the top level, to be re-filed when that comes due
+        expires = _now + SPAN - 1;
+        level = LEVELS - 1;
+    } else {
+        while (expires - _now >= uint64_t{1} << (SLOT_BITS * (level + 1))) {
+            level++;
+        }
+    }
+    const size_t slot = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+    Timer *&head = _buckets[level][slot];
+    timer._level = level;
+    timer._slot = slot;
+    timer._prev = nullptr;
+    timer._next = head;
+    if (head) {
+        head->_prev = &timer;
+    }
+    head = &timer;
+    _occupied[level] |= uint64_t{1} << slot;
+}
+
+void TimerWheel::unlink(Timer &timer) {
+    if (timer._prev) {
+        timer._prev->_next = timer._next;
+    } else {
+        _buckets[timer._level][timer._slot] = timer._next;
+        if (not timer._next) {
+            _occupied[timer._level] &= ~(uint64_t{1} << timer._slot);
+        }
+    }
+    if (timer._next) {
+        timer._next->_prev = timer._prev;
+    }
+    timer._prev = nullptr;
+    timer._next = nullptr;
+}
+
+//! \details Called when the low bits of the clock have just wrapped to zero. The bucket of level 1
+//!          covering the next 64 ms is re-filed (into level 0); if level 1 has wrapped as well, so is
+//!          the bucket of level 2, and so on.
+void TimerWheel::cascade() {
+    for (size_t level = 1; level < LEVELS; level++) {
+        const size_t slot = (_now >> (SLOT_BITS * level)) & (SLOTS - 1);
+        Timer *timer = _buckets[level][slot];
+        _buckets[level][slot] = nullptr;
+        _occupied[level] &= ~(uint64_t{1} << slot);
+        while (timer) {
+            Timer *next = timer->_next;
+            file(*timer);
+            timer = next;
+        }
+        if (slot != 0) {
+            break;
+        }
+    }
+}
+
+//! \param[in] timer the timer to arm
+//! \param[in] expires its deadline
+void TimerWheel::arm(Timer &timer, const uint64_t expires) {
+    if (timer._wheel) {
+        timer._wheel->cancel(timer);
+    }
+    // the current millisecond has already been processed
+    timer._expires = max(expires, _now + 1);
+    timer._wheel = this;
+    file(timer);
+    _size++;
+}
+
+//! \param[in] timer the timer to disarm
+void TimerWheel::cancel(Timer &timer) {
+    if (timer._wheel != this) {
+        return;
+    }
+    unlink(timer);
+    timer._wheel = nullptr;
+    _size--;
+}
+
+//! \param[in] now the new time (no effect unless it is later than now())
+size_t TimerWheel::advance(const uint64_t now) {
+    size_t expired = 0;
+    while (_now < now) {
+        if (_size == 0) {
+            _now = now;
+            break;
+        }
+        if (_occupied[0] == 0) {
+            // nothing can expire before the next cascade: skip to just before it
+            _now = min(now - 1, _now | (SLOTS - 1));
+        }
+
+        _now++;
+        if ((_now & (SLOTS - 1)) == 0) {
+            cascade();
+        }
+
+        Timer *&head = _buckets[0][_now & (SLOTS - 1)];
+        while (head) {
+            Timer &timer = *head;
+            unlink(timer);
+            timer._wheel = nullptr;
+            _size--;
+            expired++;
+            timer._callback();
+        }
+    }
+    return expired;
+}
@@ -0,0 +1,105 @@
+#ifndef SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+#define SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+//! \brief A hierarchical timing wheel with millisecond resolution
+//!
+//! Arming, re-arming and cancelling a timer are O(1): each armed timer sits on the list of one
+//! bucket, chosen by how far away its deadline is. Level 0 has a bucket for each of the next 64
+//! milliseconds; each level above covers 64 times the span of the one below. Whenever level 0
+//! wraps around, the next bucket of level 1 is redistributed ("cascaded") to the levels below,
+//! and so on up. Deadlines beyond the span of the whole wheel (about 4.6 hours) wait in the top
+//! level and are re-filed as time passes.
+//!
+//! advance() costs O(1) per millisecond (skipping 64 ms at a time while level 0 is empty) plus
+//! O(1) for each timer that expires or is cascaded, independent of how many timers are armed.
+class TimerWheel {
+  public:
+    static constexpr size_t SLOT_BITS = 6;                                  //!< log2 of the buckets per level
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;                 //!< buckets per level
+    static constexpr size_t LEVELS = 4;                                     //!< levels of the wheel
+    static constexpr uint64_t SPAN = uint64_t{1} << (SLOT_BITS * LEVELS);  //!< deadlines filed exactly (ms)
+
+    //! \brief A timer that can be armed on a TimerWheel (typically a member of the object it times)
+    //! \details A Timer that is destroyed while armed is cancelled first.
+    class Timer {
+        friend class TimerWheel;
+
+        std::function<void()> _callback;  //!< called (once) when the timer expires
+        TimerWheel *_wheel{nullptr};      //!< the wheel the timer is armed on, if any
+        Timer *_prev{nullptr};            //!< previous timer in the same bucket
+        Timer *_next{nullptr};            //!< next timer in the same bucket
+        uint64_t _expires{0};             //!< deadline
+        uint8_t _level{0};                //!< level of the bucket
+        uint8_t _slot{0};                 //!< index of the bucket within its level
+
+      public:
+        //! Create a disarmed timer that will call `callback` whenever it expires
+        explicit Timer(std::function<void()> callback) : _callback(std::move(callback)) {}
+        ~Timer() { cancel(); }
+
+        Timer(const Timer &other) = delete;
+        Timer &operator=(const Timer &other) = delete;
+
+        //! Disarm the timer (no effect if it is not armed)
+        void cancel();
+
+        //! Is the timer armed?
+        bool armed() const { return _wheel != nullptr; }
+
+        //! The deadline the timer was last armed with
+        uint64_t expires() const { return _expires; }
+    };
+
+  private:
+    std::array<std::array<Timer *, SLOTS>, LEVELS> _buckets{};  //!< head of each bucket's list
+    std::array<uint64_t, LEVELS> _occupied{};                   //!< bitmap of non-empty buckets, per level
+    uint64_t _now;                                              //!< the current time
+    size_t _size{0};                                            //!< number of armed timers
+
+    //! Link an armed timer into the bucket for its deadline, relative to the current time
+    void file(Timer &timer);
+
+    //! Unlink a timer from its bucket
+    void unlink(Timer &timer);
+
+    //! Redistribute the buckets of the upper levels that have come due at the current time
+    void cascade();
+
+  public:
+    //! Create an empty wheel whose clock reads `now` (in milliseconds)
+    explicit TimerWheel(const uint64_t now = 0) : _now(now) {}
+
+    //! Disarms every timer still armed
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel &other) = delete;
+    TimerWheel &operator=(const TimerWheel &other) = delete;
+
+    //! \brief Arm (or re-arm) `timer` to expire at time `expires`
+    //! \note A deadline that is not in the future expires at the next advance()
+    void arm(Timer &timer, const uint64_t expires);
+
+    //! \brief Arm (or re-arm) `timer` to expire `ms` milliseconds from now
+    void arm_after(Timer &timer, const uint64_t ms) { arm(timer, _now + ms); }
+
+    //! \brief Disarm `timer` (no effect if it is not armed on this wheel)
+    void cancel(Timer &timer);
+
+    //! \brief Move the clock forward to `now`, calling the callback of each timer that expires on the way
+    //! \returns the number of timers that expired
+    //! \note Callbacks run in deadline order, and may arm or cancel any timer (including their own)
+    size_t advance(const uint64_t now);
+
+    //! \brief The current time on the wheel's clock
+    uint64_t now() const { return _now; }
+
+    //! \brief The number of armed timers
+    size_t size() const { return _size; }
+};
+
+#endif  // SPONGE_LIBSPONGE_TIMER_WHEEL_HH
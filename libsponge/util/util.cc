@@ -1,22 +1,23 @@
 #include "util.hh"
 
+#include "checksum.hh"
+#include "clock.hh"
+
 #include <array>
 #include <cctype>
-#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <sys/random.h>
 #include <sys/socket.h>
 
 using namespace std;
 
+static const uint64_t program_start_ns = Clock::monotonic_ns();  //!< when the program started
+
 //! \returns the number of milliseconds since the program started
-uint64_t timestamp_ms() {
-    using time_point = std::chrono::steady_clock::time_point;
-    static const time_point program_start = std::chrono::steady_clock::now();
-    const time_point now = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(now - program_start).count();
-}
+//! \details Within an EventLoop iteration, this is the time cached for the iteration (see Clock::now_ns()).
+uint64_t timestamp_ms() { return (Clock::now_ns() - program_start_ns) / 1'000'000; }
 
 //! \param[in] attempt is the name of the syscall to try (for error reporting)
 //! \param[in] return_value is the return value of the syscall
@@ -55,16 +56,34 @@ int SystemCall(const string &attempt, const int return_value, const int errno_ma
     return SystemCall(attempt.c_str(), return_value, errno_mask);
 }
 
+//! \param[out] buf where to put the random bytes
+//! \param[in] len how many bytes to get
+//! \details Uses [getrandom(2)](\ref man2::getrandom), which blocks only until the kernel's pool is first
+//! initialized. Requests of up to 256 bytes are satisfied by a single call.
+void get_random_bytes(void *buf, const size_t len) {
+    auto *out = static_cast<uint8_t *>(buf);
+    size_t done = 0;
+    while (done < len) {
+        const ssize_t n = ::getrandom(out + done, len - done, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        done += SystemCall("getrandom", static_cast<int>(n));
+    }
+}
+
 //! \details A properly seeded mt19937 generator takes a lot of entropy!
 //!
 //! This code borrows from the following:
 //!
 //! - https://kristerw.blogspot.com/2017/05/seeding-stdmt19937-random-number-engine.html
 //! - http://www.pcg-random.org/posts/cpps-random_device.html
+//!
+//! The whole seed is read with get_random_bytes() at once, rather than 624 separate
+//! std::random_device reads.
 mt19937 get_random_generator() {
-    auto rd = random_device();
     array<uint32_t, mt19937::state_size> seed_data{};
-    generate(seed_data.begin(), seed_data.end(), [&] { return rd(); });
+    get_random_bytes(seed_data.data(), seed_data.size() * sizeof(uint32_t));
     seed_seq seed(seed_data.begin(), seed_data.end());
     return mt19937(seed);
 }
@@ -86,15 +105,16 @@ mt19937 get_random_generator() {
 //! on the Internet checksum, and consult the [IP](\ref rfc::rfc791) and [TCP](\ref rfc::rfc793) RFCs.
 InternetChecksum::InternetChecksum(const uint32_t initial_sum) : _sum(initial_sum) {}
 
+//! \details The bytes are summed by ChecksumKernel::sum() as if they began a word. If an odd number of
+//! bytes has been added so far, they actually begin in the middle of one, which swaps the two bytes of
+//! every word they contribute; the one's-complement sum of byte-swapped words is the byte-swapped sum.
 void InternetChecksum::add(std::string_view data) {
-    for (size_t i = 0; i < data.size(); i++) {
-        uint16_t val = uint8_t(data[i]);
-        if (not _parity) {
-            val <<= 8;
-        }
-        _sum += val;
-        _parity = !_parity;
+    uint16_t val = ChecksumKernel::sum(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    if (_parity) {
+        val = static_cast<uint16_t>((val << 8) | (val >> 8));
     }
+    _sum = (_sum & 0xffff) + (_sum >> 16) + val;  // fold first, so that _sum cannot overflow
+    _parity ^= (data.size() % 2 == 1);
 }
 
 uint16_t InternetChecksum::value() const {
@@ -107,6 +127,38 @@ uint16_t InternetChecksum::value() const {
     return ~ret;
 }
 
+//! \param[in] sum the folded one's-complement sum of some bytes, as if they began a 16-bit word
+//! \details Equivalent to add() of the bytes themselves, provided that they are of even length (or are
+//! the last bytes added).
+void InternetChecksum::add_sum(const uint16_t sum) {
+    const uint16_t val = _parity ? static_cast<uint16_t>((sum << 8) | (sum >> 8)) : sum;
+    _sum = (_sum & 0xffff) + (_sum >> 16) + val;
+}
+
+//! \param[in] checksum the checksum (as from value()) of data that included `old_word`
+//! \param[in] old_word the word as it was, in host byte order
+//! \param[in] new_word the word as it is now
+//! \returns the checksum of the changed data, computed as HC' = ~(~HC + ~m + m') (RFC 1624, eqn. 3)
+//! \note As RFC 1624 explains, this is exact unless the data becomes all zeros (e.g., never for a TCP
+//! segment), when it gives 0x0000 where recomputing would give 0xffff.
+uint16_t InternetChecksum::update(const uint16_t checksum, const uint16_t old_word, const uint16_t new_word) {
+    uint32_t sum = uint16_t(~checksum) + uint16_t(~old_word) + new_word;
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return ~sum;
+}
+
+//! \param[in] checksum the checksum (as from value()) of data that included `old_data`
+//! \param[in] old_data the changed bytes as they were
+//! \param[in] new_data the same bytes as they are now (if shorter or longer, the rest are taken as zeros)
+//! \returns the checksum of the changed data, at a cost proportional to the size of the change
+//! \note The changed range must begin at an even offset within the checksummed data.
+uint16_t InternetChecksum::update(const uint16_t checksum, const string_view old_data, const string_view new_data) {
+    const uint16_t old_sum = ChecksumKernel::sum(reinterpret_cast<const uint8_t *>(old_data.data()), old_data.size());
+    const uint16_t new_sum = ChecksumKernel::sum(reinterpret_cast<const uint8_t *>(new_data.data()), new_data.size());
+    return update(checksum, old_sum, new_sum);
+}
+
 //! \param[in] data is a pointer to the bytes to show
 //! \param[in] len is the number of bytes to show
 //! \param[in] indent is the number of spaces to indent
@@ -45,6 +45,9 @@ int SystemCall(const char *attempt, const int return_value, const int errno_mask
 //! Version of SystemCall that takes a C++ std::string
 int SystemCall(const std::string &attempt, const int return_value, const int errno_mask = 0);
 
+//! Fill `len` bytes at `buf` from the kernel's random number generator
+void get_random_bytes(void *buf, const size_t len);
+
 //! Seed a fast random generator
 std::mt19937 get_random_generator();
 
@@ -61,6 +64,22 @@ class InternetChecksum {
     InternetChecksum(const uint32_t initial_sum = 0);
     void add(std::string_view data);
     uint16_t value() const;
+
+    //! \brief Add data already summed elsewhere, given its one's-complement sum() (or ChecksumKernel::sum())
+    void add_sum(const uint16_t sum);
+
+    //! \brief The one's-complement sum of everything added so far (the complement of value())
+    uint16_t sum() const { return ~value(); }
+
+    //! \name Incremental update ([RFC 1624](\ref rfc::rfc1624))
+    //!@{
+
+    //! \brief The checksum after one 16-bit word it covers changes from `old_word` to `new_word`
+    static uint16_t update(const uint16_t checksum, const uint16_t old_word, const uint16_t new_word);
+
+    //! \brief The checksum after the bytes it covers at some even offset change from `old_data` to `new_data`
+    static uint16_t update(const uint16_t checksum, const std::string_view old_data, const std::string_view new_data);
+    //!@}
 };
 
 //! Hexdump the contents of a packet (or any other sequence of bytes)
@@ -0,0 +1,131 @@
+#include "block_buffer.hh"
+#include "buffer_storage.hh"
+#include "byte_stream.hh"
+#include "checksum.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+static uint16_t sum(const string &data) {
+    return ChecksumKernel::sum(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        constexpr size_t BLOCK = BlockBuffer::BLOCK;
+
+        {
+            // bytes that span blocks read back, and are summed, as if they were contiguous
+            BlockBuffer buffer;
+            size_t index = 0;
+            for (unsigned i = 0; i < 200; i++) {
+                string data(rd() % (2 * BLOCK), 0);
+                for (auto &c : data) {
+                    c = static_cast<char>(rd());
+                }
+                uint16_t in_sum = sum(data);
+                if (i % 2) {
+                    in_sum = buffer.write_and_sum(index, data);
+                } else {
+                    buffer.write(index, data);
+                }
+                string out(data.size(), 0);
+                const uint16_t out_sum = buffer.read_and_sum(index, out.data(), out.size());
+                if (out != data) {
+                    throw runtime_error("bytes read from the blocks differ from those written");
+                }
+                if (not ChecksumKernel::equal(in_sum, sum(data)) || not ChecksumKernel::equal(out_sum, sum(data))) {
+                    throw runtime_error("bytes that span blocks were summed wrongly");
+                }
+                const string_view first = buffer.contiguous(index, data.size());
+                if (not data.empty() && first != data.substr(0, BLOCK - index % BLOCK)) {
+                    throw runtime_error("contiguous() should run to the end of the block");
+                }
+                index += data.size() + rd() % 100;
+                buffer.keep(index, index);
+                if (buffer.blocks() != 0) {
+                    throw runtime_error("keep() of nothing should free every block");
+                }
+            }
+        }
+
+        {
+            // only the blocks written to are allocated, and keep() frees those outside its range
+            BlockBuffer buffer;
+            buffer.write(10, "a");
+            buffer.write(5 * BLOCK + 10, "b");
+            const BlockBuffer copy = buffer;
+            if (buffer.blocks() != 2 || copy.blocks() != 2) {
+                throw runtime_error("a gap between writes should not allocate blocks");
+            }
+            buffer.write(5 * BLOCK + 10, "B");
+            buffer.keep(BLOCK, 5 * BLOCK + 11);
+            char c = 0;
+            copy.read(5 * BLOCK + 10, &c, 1);
+            if (buffer.blocks() != 1 || c != 'b') {
+                throw runtime_error("keep() freed the wrong blocks, or a copy shared them");
+            }
+            try {
+                buffer.write(0, "x");
+                throw logic_error("a write before the bytes kept should throw");
+            } catch (const out_of_range &) {
+            }
+        }
+
+        {
+            // a ByteStream holds blocks only for the bytes it buffers, so an idle one holds none
+            const ptrdiff_t in_use = BufferPool::stats().in_use;
+            ByteStream stream{1'000'000};
+            if (BufferPool::stats().in_use != in_use) {
+                throw runtime_error("a new ByteStream should not allocate");
+            }
+            const string data(3 * BLOCK, 'x');
+            stream.write(data);
+            if (BufferPool::stats().in_use != in_use + 3) {
+                throw runtime_error("a ByteStream should allocate as it is written");
+            }
+            stream.pop_output(BLOCK + 1);
+            if (BufferPool::stats().in_use != in_use + 2) {
+                throw runtime_error("a ByteStream should free blocks as they are popped");
+            }
+            stream.set_capacity(10);
+            if (stream.read(3 * BLOCK) != data.substr(BLOCK + 1) || BufferPool::stats().in_use != in_use) {
+                throw runtime_error("a drained ByteStream should hold no blocks");
+            }
+        }
+
+        {
+            // a StreamReassembler allocates only for the bytes waiting, wherever they are in the window
+            const ptrdiff_t in_use = BufferPool::stats().in_use;
+            StreamReassembler reassembler{1'000'000};
+            reassembler.push_substring("held", 500'000, false);
+            reassembler.push_substring("later", 900'000, true);
+            if (BufferPool::stats().in_use != in_use + 2 || reassembler.unassembled_bytes() != 9) {
+                throw runtime_error("StreamReassembler should allocate one block per piece held");
+            }
+            reassembler.push_substring(string(500'000, '-'), 0, false);
+            reassembler.push_substring(string(399'996, '+'), 500'004, false);
+            const string expected = string(500'000, '-') + "held" + string(399'996, '+') + "later";
+            if (reassembler.unassembled_bytes() != 0 || not reassembler.stream_out().input_ended() ||
+                reassembler.stream_out().read(1'000'000) != expected || BufferPool::stats().in_use != in_use) {
+                throw runtime_error("StreamReassembler did not assemble and free what it held");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "buffer.hh"
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <array>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // slices of a Buffer or BufferList share its storage and match std::string's substr
+            for (unsigned i = 0; i < 1000; i++) {
+                string whole;
+                BufferList list;
+                for (size_t n = rd() % 5; n > 0; n--) {
+                    string piece(rd() % 50, 'a' + rd() % 26);
+                    whole += piece;
+                    list.append(BufferList{move(piece)});
+                }
+                const size_t pos = rd() % (whole.size() + 1);
+                const size_t len = i % 10 == 0 ? string::npos : rd() % (whole.size() + 2);
+                const BufferList slice = list.substr(pos, len);
+                if (slice.concatenate() != whole.substr(pos, len)) {
+                    throw runtime_error("BufferList::substr returned the wrong bytes");
+                }
+                for (const auto &buf : slice.buffers()) {
+                    if (buf.size() == 0) {
+                        throw runtime_error("BufferList::substr kept an empty Buffer");
+                    }
+                }
+
+                const Buffer flat{string{whole}};
+                const Buffer sub = flat.substr(pos, len);
+                if (sub.str() != whole.substr(pos, len) ||
+                    (sub.size() > 0 && sub.str().data() != flat.str().data() + pos)) {
+                    throw runtime_error("Buffer::substr did not share the original's bytes");
+                }
+                if (sub.size() > 0 && sub.substr(1).str() != whole.substr(pos, len).substr(1)) {
+                    throw runtime_error("a slice of a slice is wrong");
+                }
+            }
+
+            const Buffer small{"abc"};
+            try {
+                small.substr(4);
+                throw logic_error("Buffer::substr past the end should throw");
+            } catch (const out_of_range &) {
+            }
+        }
+
+        {
+            // lists longer than the inline storage keep their order, and fill a fixed iovec array in batches
+            BufferList list;
+            string expected;
+            for (size_t i = 0; i < 3 * BufferList::INLINE_BUFFERS; i++) {
+                string piece(1 + rd() % 50, static_cast<char>('a' + i));
+                expected += piece;
+                list.append(BufferList{std::move(piece)});
+            }
+            const size_t cut = rd() % 20;
+            list.remove_prefix(cut);
+            list.remove_suffix(cut);
+            expected = expected.substr(cut, expected.size() - 2 * cut);
+            if (list.concatenate() != expected) {
+                throw runtime_error("BufferList lost its order when it outgrew its inline storage");
+            }
+
+            const BufferViewList views{list};
+            const vector<iovec> all = views.as_iovecs();
+            array<iovec, BufferList::INLINE_BUFFERS> batch;
+            const size_t count = views.as_iovecs(batch.data(), batch.size());
+            if (all.size() != views.iovec_count() || count != batch.size() || batch[0].iov_base != all[0].iov_base ||
+                batch[count - 1].iov_len != all[count - 1].iov_len) {
+                throw runtime_error("as_iovecs() into an array disagrees with as_iovecs()");
+            }
+
+            // and what writev(2) writes from them is the whole list
+            int fds[2];
+            SystemCall("pipe", ::pipe(fds));
+            FileDescriptor reader{fds[0]}, writer{fds[1]};
+            writer.write(list);
+            writer.close();
+            string got;
+            while (not reader.eof()) {
+                got += reader.read();
+            }
+            if (got != expected) {
+                throw runtime_error("FileDescriptor::write() wrote the wrong bytes");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
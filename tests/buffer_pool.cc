@@ -0,0 +1,96 @@
+#include "buffer.hh"
+#include "buffer_storage.hh"
+#include "util.hh"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // pooled blocks are recycled, counted, and shared by reference
+            const BufferPool::Stats before = BufferPool::stats();
+            vector<Buffer> held;
+            for (size_t i = 0; i < 100; i++) {
+                BufferStorage::Ptr block = BufferPool::allocate(1 + rd() % 1500);
+                if (not block->pooled()) {
+                    throw runtime_error("an MTU-sized block should come from the pool");
+                }
+                memset(block->data(), 'a' + i % 26, block->size());
+                held.emplace_back(std::move(block));
+            }
+            const Buffer copy = held.front();
+            held.clear();
+            const BufferPool::Stats &after = BufferPool::stats();
+            if (after.in_use != before.in_use + 1 || after.high_water < before.in_use + 100 ||
+                copy.str() != string(copy.size(), 'a')) {
+                throw runtime_error("pool did not count blocks in use");
+            }
+            const size_t hits = after.hits;
+            for (size_t i = 0; i < 99; i++) {
+                BufferPool::allocate(1500);
+            }
+            if (after.hits != hits + 99) {
+                throw runtime_error("freed blocks were not reused");
+            }
+            const size_t misses = after.misses;
+            const Buffer big{BufferPool::allocate(BufferPool::MAX_BLOCK + 1)};
+            if (after.misses != misses + 1 || big.size() != BufferPool::MAX_BLOCK + 1) {
+                throw runtime_error("an oversized block should be allocated on its own");
+            }
+
+            // a block freed by another thread goes on that thread's free list
+            Buffer elsewhere{BufferPool::allocate(100)};
+            ptrdiff_t in_use_there = 0;
+            thread{[&, moved = std::move(elsewhere)]() mutable {
+                moved = Buffer{};
+                in_use_there = BufferPool::stats().in_use;
+            }}.join();
+            if (in_use_there != -1) {
+                throw runtime_error("block freed by another thread was not counted there");
+            }
+        }
+
+        {
+            // storage made by a thread confined to itself is counted the same way, just not atomically
+            BufferStorage::confine_to_this_thread();
+            BufferStorage::Ptr block = BufferPool::allocate(100);
+            Buffer adopted{string(100, 'x')};
+            BufferStorage::confine_to_this_thread(false);
+            const BufferStorage::Ptr shared = BufferPool::allocate(100);
+            if (not block->confined() || shared->confined()) {
+                throw runtime_error("storage was not confined as its thread asked");
+            }
+            const ptrdiff_t in_use = BufferPool::stats().in_use;
+            {
+                const BufferStorage::Ptr copy = block;
+                const Buffer copied = adopted;
+                if (block.use_count() != 2 || copied.substr(1).size() != 99) {
+                    throw runtime_error("confined storage miscounted its references");
+                }
+            }
+            block.reset();
+            adopted = Buffer{};
+            if (BufferPool::stats().in_use != in_use - 1) {
+                throw runtime_error("confined storage was not freed with its last reference");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,303 @@
+#include "checksum.hh"
+#include "parser.hh"
+#include "tcp_checksum_offload.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+namespace {
+
+//! InternetChecksum as it was first written: one byte at a time
+class ReferenceChecksum {
+    uint32_t _sum;
+    bool _parity{};
+
+  public:
+    explicit ReferenceChecksum(const uint32_t initial_sum) : _sum(initial_sum) {}
+
+    void add(string_view data) {
+        for (const char c : data) {
+            uint16_t val = static_cast<uint8_t>(c);
+            if (not _parity) {
+                val <<= 8;
+            }
+            _sum += val;
+            _parity = !_parity;
+        }
+    }
+
+    uint16_t value() const {
+        uint32_t ret = _sum;
+        while (ret > 0xffff) {
+            ret = (ret >> 16) + (ret & 0xffff);
+        }
+        return ~ret;
+    }
+};
+
+}  // namespace
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const auto random_bytes = [&](const size_t len) {
+            string s(len, 0);
+            for (auto &c : s) {
+                c = static_cast<char>(rd());
+            }
+            return s;
+        };
+
+        {
+            // every kernel agrees with the bytewise one, for any length and alignment
+            const string buf = random_bytes(5000);
+            const string ones(5000, '\xff');
+            const auto *data = reinterpret_cast<const uint8_t *>(buf.data());
+            using Variant = ChecksumKernel::Variant;
+            for (const Variant variant : {Variant::Word, Variant::SSE2, Variant::AVX2}) {
+                if (not ChecksumKernel::supported(variant)) {
+                    cerr << "note: skipping unsupported checksum kernel " << ChecksumKernel::name(variant) << "\n";
+                    continue;
+                }
+                for (unsigned i = 0; i < 20000; i++) {
+                    const size_t offset = rd() % 64;
+                    const size_t len = (i < 200) ? i : rd() % (buf.size() - offset);
+                    const uint16_t expected = ChecksumKernel::sum(Variant::Bytewise, data + offset, len);
+                    if (ChecksumKernel::sum(variant, data + offset, len) != expected) {
+                        throw runtime_error(string(ChecksumKernel::name(variant)) + " kernel disagrees at offset " +
+                                            to_string(offset) + ", length " + to_string(len));
+                    }
+                }
+                // copy_and_sum copies exactly `len` bytes and sums them like sum()
+                for (unsigned i = 0; i < 2000; i++) {
+                    const size_t offset = rd() % 64;
+                    const size_t len = (i < 200) ? i : rd() % (buf.size() - offset);
+                    string dst(len + 2, '#');
+                    auto *out = reinterpret_cast<uint8_t *>(&dst[1]);
+                    const uint16_t sum = ChecksumKernel::copy_and_sum(variant, out, data + offset, len);
+                    if (sum != ChecksumKernel::sum(Variant::Bytewise, data + offset, len) ||
+                        dst.substr(1, len) != buf.substr(offset, len) || dst.front() != '#' || dst.back() != '#') {
+                        throw runtime_error(string(ChecksumKernel::name(variant)) +
+                                            " copy_and_sum is wrong at length " + to_string(len));
+                    }
+                }
+
+                // all-ones words are the worst case for carries
+                const auto *ff = reinterpret_cast<const uint8_t *>(ones.data());
+                if (ChecksumKernel::sum(variant, ff, ones.size()) != 0xffff ||
+                    ChecksumKernel::sum(variant, ff, 0) != 0) {
+                    throw runtime_error(string(ChecksumKernel::name(variant)) + " kernel mishandles carries");
+                }
+
+                // an empty payload may have no storage at all
+                if (ChecksumKernel::sum(variant, nullptr, 0) != 0 ||
+                    ChecksumKernel::copy_and_sum(variant, nullptr, nullptr, 0) != 0) {
+                    throw runtime_error(string(ChecksumKernel::name(variant)) + " kernel mishandles an empty payload");
+                }
+            }
+        }
+
+        {
+            // InternetChecksum gives the same value as before, however the data is split into add() calls
+            for (unsigned i = 0; i < 5000; i++) {
+                const uint32_t initial = (i % 2 == 0) ? rd() % 0x3'0000 : 0;
+                const string data = random_bytes(rd() % 3000);
+                InternetChecksum fast{initial};
+                ReferenceChecksum reference{initial};
+                for (size_t pos = 0; pos < data.size();) {
+                    const size_t chunk = min(data.size() - pos, size_t{rd() % 100});
+                    fast.add(string_view{data}.substr(pos, chunk));
+                    reference.add(string_view{data}.substr(pos, chunk));
+                    pos += chunk;
+                }
+                if (fast.value() != reference.value()) {
+                    throw runtime_error("InternetChecksum of " + to_string(data.size()) + " bytes changed");
+                }
+            }
+        }
+
+        {
+            // RFC 1624 updates agree with recomputing the checksum from scratch
+            const auto full = [](const string &data) {
+                InternetChecksum check;
+                check.add(data);
+                return check.value();
+            };
+            for (unsigned i = 0; i < 5000; i++) {
+                // (RFC 1624 eqn. 3 yields 0x0000 instead of 0xffff if the data becomes all zeros; keep one byte set)
+                string data = random_bytes(2 + rd() % 200) + '\x01';
+                uint16_t checksum = full(data);
+
+                // one word
+                const size_t at = 2 * (rd() % ((data.size() - 1) / 2));
+                const uint16_t old_word = (uint8_t(data[at]) << 8) | uint8_t(data[at + 1]);
+                const uint16_t new_word = (i % 10 == 0) ? 0 : rd();
+                data[at] = static_cast<char>(new_word >> 8);
+                data[at + 1] = static_cast<char>(new_word);
+                checksum = InternetChecksum::update(checksum, old_word, new_word);
+                if (checksum != full(data)) {
+                    throw runtime_error("RFC 1624 update of one word disagrees with a full checksum");
+                }
+
+                // a range of bytes
+                const size_t start = 2 * (rd() % ((data.size() - 1) / 2));
+                const size_t len = rd() % (data.size() - start);
+                const string old_data = data.substr(start, len);
+                const string new_data = random_bytes(len);
+                data.replace(start, len, new_data);
+                checksum = InternetChecksum::update(checksum, old_data, new_data);
+                if (checksum != full(data)) {
+                    throw runtime_error("RFC 1624 update of a range disagrees with a full checksum");
+                }
+            }
+        }
+
+        {
+            // a segment re-serialized with new header fields (reusing the cached payload sum) matches a fresh one
+            for (unsigned i = 0; i < 1000; i++) {
+                const uint32_t pseudo = rd() % 0x4'0000;
+                TCPSegment seg;
+                seg.header().seqno = WrappingInt32{static_cast<uint32_t>(rd())};
+                seg.payload() = Buffer{random_bytes(rd() % 2000)};
+                seg.serialize(pseudo);
+
+                seg.header().ack = true;
+                seg.header().ackno = WrappingInt32{static_cast<uint32_t>(rd())};
+                seg.header().win = rd();
+                if (i % 3 == 0) {
+                    seg.payload() = Buffer{random_bytes(rd() % 2000)};  // the cache must notice
+                }
+                const string wire = seg.serialize(pseudo).concatenate();
+
+                TCPSegment fresh;
+                fresh.header() = seg.header();
+                fresh.payload() = Buffer{seg.payload().copy()};
+                if (wire != fresh.serialize(pseudo).concatenate()) {
+                    throw runtime_error("re-serialized segment has the wrong checksum");
+                }
+                TCPSegment parsed;
+                if (const auto res = parsed.parse(string{wire}, pseudo); res != ParseResult::NoError) {
+                    throw runtime_error("re-serialized segment failed to parse: " + as_string(res));
+                }
+            }
+        }
+
+        {
+            // a checksum left to the receiver is verified as the payload is copied, or before it is processed
+            const auto wire = [](const TCPSegment &seg, const uint32_t pseudo) {
+                return seg.serialize(pseudo).concatenate();
+            };
+            for (unsigned i = 0; i < 200; i++) {
+                const uint32_t pseudo = rd() % 0x4'0000;
+                TCPReceiver receiver{4000};
+                const WrappingInt32 isn{static_cast<uint32_t>(rd())};
+                TCPSegment syn;
+                syn.header().syn = true;
+                syn.header().seqno = isn;
+                receiver.segment_received(syn);
+
+                const string first = random_bytes(1 + rd() % 1000);
+                const string second = random_bytes(1 + rd() % 1000);
+                TCPSegment a;
+                a.header().seqno = isn + 1;
+                a.payload() = Buffer{string{first}};
+                TCPSegment b;
+                b.header().seqno = isn + 1 + first.size();
+                b.payload() = Buffer{string{second}};
+                string wire_a = wire(a, pseudo);
+                string wire_b = wire(b, pseudo);
+
+                // out of order: the second segment is verified before it is stored, and the corrupt copy dropped
+                const bool corrupt = i % 2 == 0;
+                string bad_b = wire_b;
+                bad_b[20 + rd() % second.size()] ^= 1 << (rd() % 8);
+                TCPSegment parsed;
+                if (parsed.parse(string{corrupt ? bad_b : wire_b}, pseudo, true) != ParseResult::NoError ||
+                    parsed.payload_verified()) {
+                    throw runtime_error("deferred parse should leave the payload unverified");
+                }
+                receiver.segment_received(parsed);
+                if (receiver.unassembled_bytes() != (corrupt ? 0 : second.size()) ||
+                    receiver.bad_checksums() != corrupt) {
+                    throw runtime_error("out-of-order segment with a deferred checksum mishandled");
+                }
+
+                // in order: verified as it is copied into the stream; a corrupt copy leaves no trace
+                string bad_a = wire_a;
+                bad_a[20 + rd() % first.size()] ^= 1 << (rd() % 8);
+                parsed.parse(string{bad_a}, pseudo, true);
+                receiver.segment_received(parsed);
+                if (receiver.stream_out().buffer_size() != 0 || receiver.ackno() != isn + 1 ||
+                    receiver.bad_checksums() != corrupt + 1u) {
+                    throw runtime_error("corrupt in-order segment was not dropped");
+                }
+                parsed.parse(string{wire_a}, pseudo, true);
+                receiver.segment_received(parsed);
+                if (corrupt) {
+                    parsed.parse(string{wire_b}, pseudo, true);
+                    receiver.segment_received(parsed);
+                }
+                if (receiver.stream_out().peek_output(8000) != first + second ||
+                    receiver.bad_checksums() != corrupt + 1u) {
+                    throw runtime_error("segments with deferred checksums were not delivered");
+                }
+            }
+        }
+
+        {
+            // each policy parses and serializes as configured, and counts what it did
+            const uint32_t pseudo = rd() % 0x4'0000;
+            TCPSegment seg;
+            seg.header().seqno = WrappingInt32{static_cast<uint32_t>(rd())};
+            seg.payload() = Buffer{random_bytes(1 + rd() % 2000)};
+            string bad = seg.serialize(pseudo).concatenate();
+            bad[20] ^= 1;
+
+            TCPChecksumOffload verify;
+            TCPSegment parsed;
+            if (verify.parse(parsed, string{bad}, pseudo) != ParseResult::BadChecksum ||
+                verify.parse(parsed, string{bad}, pseudo, true) != ParseResult::NoError ||
+                verify.serialize(seg, pseudo).concatenate() != seg.serialize(pseudo).concatenate() ||
+                verify.stats().verified != 1 || verify.stats().deferred != 1 || verify.stats().computed != 1) {
+                throw runtime_error("ChecksumPolicy::Verify should behave like TCPSegment");
+            }
+
+            TCPChecksumOffload skip{ChecksumPolicy::SkipVerify};
+            if (skip.parse(parsed, string{bad}, pseudo, true) != ParseResult::NoError ||
+                not parsed.payload_verified() ||
+                skip.serialize(seg, pseudo).concatenate() != seg.serialize(pseudo).concatenate() ||
+                skip.stats().skipped != 1 || skip.stats().computed != 1) {
+                throw runtime_error("ChecksumPolicy::SkipVerify should accept a bad checksum");
+            }
+
+            // the device completes a partial checksum by summing the whole segment
+            TCPChecksumOffload partial{ChecksumPolicy::PartialOffload};
+            string wire = partial.serialize(seg, pseudo).concatenate();
+            InternetChecksum device;
+            device.add(wire);
+            const uint16_t cksum = device.value();
+            wire[16] = static_cast<char>(cksum >> 8);
+            wire[17] = static_cast<char>(cksum);
+            if (wire != seg.serialize(pseudo).concatenate() || partial.stats().partial != 1 ||
+                partial.parse(parsed, string{bad}, pseudo) != ParseResult::NoError || partial.stats().skipped != 1) {
+                throw runtime_error("partially offloaded checksum was not completed correctly");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
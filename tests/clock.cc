@@ -0,0 +1,95 @@
+#include "clock.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            // each clock reads CLOCK_MONOTONIC, never goes backwards, and the coarse one lags by at most a tick
+            const uint64_t tick = Clock::coarse_resolution_ns();
+            if (tick == 0 || tick > 100'000'000) {
+                throw runtime_error("implausible CLOCK_MONOTONIC_COARSE resolution: " + to_string(tick));
+            }
+            uint64_t last = 0;
+            uint64_t last_coarse = 0;
+            for (unsigned i = 0; i < 100000; i++) {
+                const uint64_t before = Clock::monotonic_ns();
+                const uint64_t coarse = Clock::coarse_ns();
+                const uint64_t now = Clock::monotonic_ns();
+                if (before < last || now < before || coarse < last_coarse) {
+                    throw runtime_error("a clock went backwards");
+                }
+                if (coarse > now) {
+                    throw runtime_error("the coarse clock is ahead of CLOCK_MONOTONIC");
+                }
+                // the lag is only meaningful if the thread was not preempted between the readings
+                if (now - before < tick / 2 && before - min(before, coarse) > 2 * tick) {
+                    throw runtime_error("the coarse clock is off by more than a tick");
+                }
+                last = now;
+                last_coarse = coarse;
+            }
+        }
+
+        {
+            // within an iteration, now_ns() and timestamp_ms() hold still; iterations nest
+            if (Clock::cached()) {
+                throw runtime_error("no iteration should be in progress");
+            }
+            const uint64_t before = Clock::monotonic_ns();
+            Clock::Iteration outer;
+            const uint64_t t = Clock::now_ns();
+            const uint64_t ms = timestamp_ms();
+            if (t < before || not Clock::cached()) {
+                throw runtime_error("iteration did not cache the time");
+            }
+            while (Clock::monotonic_ns() < t + 3'000'000) {
+            }
+            if (Clock::now_ns() != t || timestamp_ms() != ms) {
+                throw runtime_error("cached time moved during an iteration");
+            }
+            {
+                Clock::Iteration inner;
+                if (Clock::now_ns() < t + 3'000'000) {
+                    throw runtime_error("a nested iteration should read the clock afresh");
+                }
+            }
+            if (Clock::now_ns() != t) {
+                throw runtime_error("the outer iteration's time should apply again");
+            }
+        }
+        if (Clock::cached() || Clock::now_ns() == 0) {
+            throw runtime_error("outside an iteration, now_ns() should read the clock");
+        }
+
+        if (TSC::available()) {
+            // the calibrated TSC agrees with CLOCK_MONOTONIC to within 100 us
+            for (unsigned i = 0; i < 10; i++) {
+                const uint64_t a = Clock::monotonic_ns();
+                const uint64_t tsc = TSC::ns();
+                const uint64_t b = Clock::monotonic_ns();
+                if (tsc + 100'000 < a || tsc > b + 100'000) {
+                    throw runtime_error("TSC reads " + to_string(tsc) + " ns, CLOCK_MONOTONIC " + to_string(a));
+                }
+                while (Clock::monotonic_ns() < b + 1'000'000) {
+                }
+            }
+        } else if (TSC::ns() == 0) {
+            throw runtime_error("without a TSC, TSC::ns() should fall back to CLOCK_MONOTONIC");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include "buffer.hh"
+#include "buffer_storage.hh"
+#include "huge_page_arena.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            // allocations are aligned, zero-filled, and spill into a new chunk when one is full
+            HugePageArena arena{HugePageArena::HUGE_PAGE};
+            const char *end = nullptr;
+            for (const size_t alignment : {1, 8, 64, 4096}) {
+                auto *p = static_cast<char *>(arena.allocate(1000, alignment));
+                if (reinterpret_cast<uintptr_t>(p) % alignment != 0 || p < end) {
+                    throw runtime_error("misplaced allocation");
+                }
+                for (size_t i = 0; i < 1000; i++) {
+                    if (p[i] != 0) {
+                        throw runtime_error("allocation was not zero-filled");
+                    }
+                }
+                p[999] = 'x';
+                end = p + 1000;
+            }
+            auto *big = static_cast<char *>(arena.allocate(HugePageArena::HUGE_PAGE + 1));
+            big[HugePageArena::HUGE_PAGE] = 'x';
+            const auto stats = arena.stats();
+            if (stats.chunks != 2 || stats.mapped < 3 * HugePageArena::HUGE_PAGE ||
+                stats.allocated != 4000 + HugePageArena::HUGE_PAGE + 1 || stats.hugetlb + stats.transparent > 2) {
+                throw runtime_error("arena counters are wrong");
+            }
+            if (arena.backing(big) == HugePageArena::Backing::HugeTLB && stats.hugetlb == 0) {
+                throw runtime_error("backing() disagrees with stats()");
+            }
+            try {
+                arena.allocate(1, 3);
+                throw logic_error("accepted an alignment that is not a power of two");
+            } catch (const invalid_argument &) {
+            }
+        }
+
+        {
+            // once the BufferPool is given an arena, new slabs come from it (a new thread has no free blocks yet)
+            static HugePageArena arena{};
+            BufferPool::set_arena(&arena);
+            Buffer buffer;
+            thread{[&] {
+                BufferStorage::Ptr block = BufferPool::allocate(1500);
+                block->data()[0] = 'x';
+                arena.backing(block->data());
+                buffer = Buffer{std::move(block)};
+            }}.join();
+            BufferPool::set_arena(nullptr);
+            if (buffer.str().front() != 'x' || arena.stats().allocated == 0 ||
+                arena.stats().allocated > BufferPool::SLAB_BYTES) {
+                throw runtime_error("BufferPool did not take its slab from the arena");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include "buffer.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // a serialized segment and the headers prepended to it share one allocation
+            TCPSegment seg;
+            seg.header().seqno = WrappingInt32{static_cast<uint32_t>(rd())};
+            seg.header().options.ts = TCPOptions::Timestamps{static_cast<uint32_t>(rd()), 0};
+            seg.payload() = string(1 + rd() % 1400, 'x');
+            const uint32_t pseudo = rd() % 0x4'0000;
+
+            PacketBuffer packet = seg.serialize_packet(pseudo);
+            if (packet.str() != seg.serialize(pseudo).concatenate() ||
+                packet.headroom() != PacketBuffer::DEFAULT_HEADROOM) {
+                throw runtime_error("serialize_packet() disagrees with serialize()");
+            }
+
+            const char *tcp = packet.str().data();
+            memset(packet.prepend(20), 'i', 20);
+            memset(packet.prepend(14), 'e', 14);
+            if (packet.str().data() + 34 != tcp || packet.headroom() != PacketBuffer::DEFAULT_HEADROOM - 34 ||
+                packet.str() != string(14, 'e') + string(20, 'i') + seg.serialize(pseudo).concatenate() ||
+                BufferViewList{packet}.as_iovecs().size() != 1) {
+                throw runtime_error("headers were not prepended in place");
+            }
+        }
+
+        {
+            // running out of headroom moves the packet
+            PacketBuffer packet{"payload", 4};
+            memcpy(packet.prepend(4), "abcd", 4);
+            memcpy(packet.prepend(10), "0123456789", 10);
+            if (packet.str() != "0123456789abcdpayload" || packet.headroom() != PacketBuffer::DEFAULT_HEADROOM) {
+                throw runtime_error("packet was not moved to a larger allocation");
+            }
+            packet.remove_prefix(14);
+            if (packet.str() != "payload" || packet.headroom() != PacketBuffer::DEFAULT_HEADROOM + 14) {
+                throw runtime_error("remove_prefix() did not return the bytes to the headroom");
+            }
+        }
+
+        {
+            // a Buffer handed out keeps its bytes, even once they are back in the headroom
+            PacketBuffer packet{"payload"};
+            memcpy(packet.prepend(6), "header", 6);
+            const Buffer shared = packet.buffer();
+            packet.remove_prefix(6);
+            memcpy(packet.prepend(6), "HEADER", 6);
+            if (shared.str() != "headerpayload" || packet.str() != "HEADERpayload") {
+                throw runtime_error("prepend() overwrote bytes that a Buffer can see");
+            }
+            memcpy(packet.prepend(2), "..", 2);
+            if (shared.str() != "headerpayload" || packet.str() != "..HEADERpayload") {
+                throw runtime_error("prepend() overwrote bytes that a Buffer can see");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -84,6 +84,21 @@ struct ExpectWindow : public ReceiverExpectation {
     }
 };
 
+struct ExpectCapacity : public ReceiverExpectation {
+    size_t _capacity;
+
+    ExpectCapacity(const size_t capacity) : _capacity(capacity) {}
+    std::string description() const { return "capacity " + std::to_string(_capacity); }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.capacity() != _capacity) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported capacity `" +
+                                               std::to_string(receiver.capacity()) + "`, but it was expected to be `" +
+                                               std::to_string(_capacity) + "`");
+        }
+    }
+};
+
 struct ExpectUnassembledBytes : public ReceiverExpectation {
     size_t _n_bytes;
 
@@ -116,6 +131,106 @@ struct ExpectTotalAssembledBytes : public ReceiverExpectation {
     }
 };
 
+struct ExpectTsRecent : public ReceiverExpectation {
+    std::optional<uint32_t> _ts_recent;
+
+    ExpectTsRecent(std::optional<uint32_t> ts_recent) : _ts_recent(ts_recent) {}
+    std::string description() const {
+        return _ts_recent.has_value() ? "TS.Recent " + std::to_string(_ts_recent.value()) : "no TS.Recent";
+    }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ts_recent() != _ts_recent) {
+            std::string reported =
+                receiver.ts_recent().has_value() ? std::to_string(receiver.ts_recent().value()) : "none";
+            std::string expected = _ts_recent.has_value() ? std::to_string(_ts_recent.value()) : "none";
+            throw ReceiverExpectationViolation("The TCPReceiver reported TS.Recent `" + reported +
+                                               "`, but it was expected to be `" + expected + "`");
+        }
+    }
+};
+
+struct ExpectAckDue : public ReceiverExpectation {
+    bool _due;
+
+    ExpectAckDue(const bool due) : _due(due) {}
+    std::string description() const { return _due ? "ACK due" : "no ACK due"; }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ack_due() != _due) {
+            throw ReceiverExpectationViolation(std::string("The TCPReceiver reported ack_due() == ") +
+                                               (receiver.ack_due() ? "true" : "false") + ", but it was expected to be " +
+                                               (_due ? "true" : "false"));
+        }
+    }
+};
+
+struct ExpectEce : public ReceiverExpectation {
+    bool _ece;
+
+    ExpectEce(const bool ece) : _ece(ece) {}
+    std::string description() const { return _ece ? "ECE on ACKs" : "no ECE on ACKs"; }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ece() != _ece) {
+            throw ReceiverExpectationViolation(std::string("The TCPReceiver reported ece() == ") +
+                                               (receiver.ece() ? "true" : "false") + ", but it was expected to be " +
+                                               (_ece ? "true" : "false"));
+        }
+    }
+};
+
+struct ExpectCeTransitionAck : public ReceiverExpectation {
+    std::optional<TCPReceiver::EcnAck> _ack;
+
+    ExpectCeTransitionAck(const std::optional<TCPReceiver::EcnAck> ack) : _ack(ack) {}
+    std::string description() const {
+        if (not _ack.has_value()) {
+            return "no ACK owed for data before a CE change";
+        }
+        return "ACK of " + std::to_string(_ack.value().ackno.raw_value()) + (_ack.value().ece ? " with" : " without") +
+               " ECE owed for data before a CE change";
+    }
+
+    void execute(TCPReceiver &receiver) const {
+        const auto &ack = receiver.ce_transition_ack();
+        if (ack.has_value() != _ack.has_value() ||
+            (ack.has_value() && (ack.value().ackno != _ack.value().ackno || ack.value().ece != _ack.value().ece))) {
+            throw ReceiverExpectationViolation("The TCPReceiver owed the wrong ACK for data before a CE change");
+        }
+    }
+};
+
+struct ExpectCeMarks : public ReceiverExpectation {
+    size_t _marks;
+
+    ExpectCeMarks(const size_t marks) : _marks(marks) {}
+    std::string description() const { return std::to_string(_marks) + " CE-marked segments"; }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ce_marks() != _marks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported " + std::to_string(receiver.ce_marks()) +
+                                               " CE-marked segments, but there were expected to be " +
+                                               std::to_string(_marks));
+        }
+    }
+};
+
+struct ExpectAcksSent : public ReceiverExpectation {
+    size_t _acks;
+
+    ExpectAcksSent(const size_t acks) : _acks(acks) {}
+    std::string description() const { return std::to_string(_acks) + " ACKs sent"; }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ack_stats().acks_sent != _acks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported " +
+                                               std::to_string(receiver.ack_stats().acks_sent) +
+                                               " ACKs sent, but it was expected to be " + std::to_string(_acks));
+        }
+    }
+};
+
 struct ExpectEof : public ReceiverExpectation {
     ExpectEof() {}
     std::string description() const { return "receiver.stream_out().eof() == true"; }
@@ -174,6 +289,24 @@ struct ReceiverAction : public ReceiverTestStep {
     virtual ~ReceiverAction() {}
 };
 
+struct TimePasses : public ReceiverAction {
+    size_t ms;
+
+    TimePasses(const size_t ms_) : ms(ms_) {}
+    std::string description() const { return std::to_string(ms) + " ms pass"; }
+    void execute(TCPReceiver &receiver) const { receiver.tick(ms); }
+};
+
+//! Send an ACK if one is due, as the connection would after each event
+struct SendAckIfDue : public ReceiverAction {
+    std::string description() const { return "send ACK if due"; }
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ack_due()) {
+            receiver.ack_sent();
+        }
+    }
+};
+
 struct SegmentArrives : public ReceiverAction {
     enum class Result { NOT_SYN, OK };
 
@@ -192,10 +325,15 @@ struct SegmentArrives : public ReceiverAction {
     bool rst{};
     bool syn{};
     bool fin{};
+    bool psh{};
+    bool ece{};
+    bool cwr{};
+    bool ce{};
     WrappingInt32 seqno{0};
     WrappingInt32 ackno{0};
     uint16_t win{};
     std::string data{};
+    std::optional<TCPOptions::Timestamps> ts{};
     std::optional<Result> result{};
 
     SegmentArrives &with_ack(WrappingInt32 ackno_) {
@@ -221,6 +359,27 @@ struct SegmentArrives : public ReceiverAction {
         return *this;
     }
 
+    SegmentArrives &with_psh() {
+        psh = true;
+        return *this;
+    }
+
+    SegmentArrives &with_ece() {
+        ece = true;
+        return *this;
+    }
+
+    SegmentArrives &with_cwr() {
+        cwr = true;
+        return *this;
+    }
+
+    //! the IP datagram carrying the segment was marked Congestion Experienced
+    SegmentArrives &with_ce() {
+        ce = true;
+        return *this;
+    }
+
     SegmentArrives &with_seqno(WrappingInt32 seqno_) {
         seqno = seqno_;
         return *this;
@@ -238,6 +397,11 @@ struct SegmentArrives : public ReceiverAction {
         return *this;
     }
 
+    SegmentArrives &with_ts(uint32_t val_, uint32_t ecr_ = 0) {
+        ts = TCPOptions::Timestamps{val_, ecr_};
+        return *this;
+    }
+
     SegmentArrives &with_result(Result result_) {
         result = result_;
         return *this;
@@ -250,9 +414,13 @@ struct SegmentArrives : public ReceiverAction {
         seg.header().fin = fin;
         seg.header().syn = syn;
         seg.header().rst = rst;
+        seg.header().psh = psh;
+        seg.header().ece = ece;
+        seg.header().cwr = cwr;
         seg.header().ackno = ackno;
         seg.header().seqno = seqno;
         seg.header().win = win;
+        seg.header().options.ts = ts;
         return seg;
     }
 
@@ -261,6 +429,9 @@ struct SegmentArrives : public ReceiverAction {
         std::ostringstream o;
         o << "segment arrives ";
         o << seg.header().summary();
+        if (ce) {
+            o << " marked CE";
+        }
         if (data.size() > 0) {
             o << " with data \"" << data << "\"";
         }
@@ -275,7 +446,7 @@ struct SegmentArrives : public ReceiverAction {
             o << " with data \"" << data << "\"";
         }
 
-        receiver.segment_received(std::move(seg));
+        receiver.segment_received(std::move(seg), ce);
 
         Result res;
 
@@ -304,6 +475,14 @@ class TCPReceiverTestHarness {
            << "capacity=" << capacity << ")";
         steps_executed.emplace_back(ss.str());
     }
+    TCPReceiverTestHarness(const TCPConfig &config) : receiver(config), steps_executed() {
+        std::ostringstream ss;
+        ss << "Initialized with ("
+           << "capacity=" << config.recv_capacity << ", timestamps=" << config.timestamps
+           << ", delack_timeout=" << config.delack_timeout << ", recv_capacity_max=" << config.recv_capacity_max
+           << ")";
+        steps_executed.emplace_back(ss.str());
+    }
     void execute(const ReceiverTestStep &step) {
         try {
             step.execute(receiver);
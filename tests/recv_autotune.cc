@@ -0,0 +1,102 @@
+#include "receiver_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // without a maximum, the capacity is fixed
+            TCPConfig cfg;
+            cfg.recv_capacity = 4000;
+            cfg.rt_timeout = 100;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(string(4000, 'a')));
+            test.execute(ExpectBytes{string(4000, 'a')});
+            test.execute(TimePasses{1000});
+            test.execute(ExpectCapacity{4000});
+            test.execute(ExpectWindow{4000});
+        }
+
+        {
+            // a fast reader grows the buffer up to the maximum; an idle connection shrinks it again
+            TCPConfig cfg;
+            cfg.recv_capacity = 1000;
+            cfg.recv_capacity_max = 8000;
+            cfg.rt_timeout = 100;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+
+            size_t seqno = 1;
+            size_t capacity = 1000;
+            for (const size_t expected : {2000, 4000, 8000, 8000}) {
+                const string data(capacity, 'x');
+                test.execute(SegmentArrives{}.with_seqno(isn + seqno).with_data(data));
+                test.execute(ExpectWindow{0});
+                test.execute(ExpectBytes{string(data)});
+                test.execute(TimePasses{99});
+                test.execute(ExpectCapacity{capacity});
+                test.execute(TimePasses{1});
+                test.execute(ExpectCapacity{expected});
+                test.execute(ExpectWindow{expected});
+                seqno += capacity;
+                capacity = expected;
+            }
+
+            for (const size_t expected : {4000, 2000, 1000, 1000}) {
+                test.execute(TimePasses{100});
+                test.execute(ExpectCapacity{expected});
+            }
+        }
+
+        {
+            // shrinking never retracts the advertised window
+            TCPConfig cfg;
+            cfg.recv_capacity = 4000;
+            cfg.recv_capacity_max = 8000;
+            cfg.rt_timeout = 100;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(string(4000, 'x')));
+            test.execute(ExpectBytes{string(4000, 'x')});
+            test.execute(TimePasses{100});
+            test.execute(ExpectCapacity{8000});
+
+            // the peer is told about an 8000-byte window, then 3000 bytes arrive and wait to be read
+            test.execute(SendAckIfDue{});
+            test.execute(ExpectAckno{WrappingInt32{isn + 4001}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 4001).with_data(string(3000, 'y')));
+            test.execute(TimePasses{100});
+            test.execute(TimePasses{100});
+            test.execute(ExpectCapacity{8000});
+            test.execute(ExpectWindow{5000});
+
+            // once they are read, the buffer may shrink, but only to the edge already advertised
+            test.execute(ExpectBytes{string(3000, 'y')});
+            test.execute(TimePasses{100});
+            test.execute(ExpectCapacity{8000});
+            test.execute(TimePasses{100});
+            test.execute(ExpectCapacity{5000});
+            test.execute(ExpectWindow{5000});
+            test.execute(TimePasses{100});
+            test.execute(ExpectCapacity{5000});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
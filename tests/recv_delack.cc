@@ -0,0 +1,167 @@
+#include "receiver_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // without delayed ACKs, every segment is acknowledged at once
+            TCPConfig cfg;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh"));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(ExpectAcksSent{3});
+        }
+
+        {
+            // every second full-sized segment is acknowledged; a lone one waits for the timer
+            TCPConfig cfg;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 0;
+            uint32_t isn = rd();
+            const string full(1000, 'x');
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(full));
+            test.execute(ExpectAckDue{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1001).with_data(full));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 2001).with_data(full));
+            test.execute(ExpectAckDue{false});
+            test.execute(TimePasses{39});
+            test.execute(ExpectAckDue{false});
+            test.execute(TimePasses{1});
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(TimePasses{1000});
+            test.execute(ExpectAckDue{false});
+            test.execute(ExpectAcksSent{3});
+        }
+
+        {
+            // out-of-order data, and data that fills a hole, are acknowledged immediately
+            TCPConfig cfg;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 0;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh"));
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectAckno{WrappingInt32{isn + 1}});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectAckno{WrappingInt32{isn + 9}});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 9).with_data("ijkl"));
+            test.execute(ExpectAckDue{false});
+        }
+
+        {
+            // PSH and FIN are acknowledged immediately; a pure ACK is not acknowledged at all
+            TCPConfig cfg;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 0;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_ack(0));
+            test.execute(ExpectAckDue{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_psh());
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_fin());
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectBytes{"abcd"});
+            test.execute(ExpectEof{});
+        }
+
+        {
+            // quick-ack: the first segments are acknowledged immediately, then ACKs are delayed
+            TCPConfig cfg;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 2;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh"));
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 9).with_data("ijkl"));
+            test.execute(ExpectAckDue{false});
+            test.execute(TimePasses{40});
+            test.execute(ExpectAckDue{true});
+        }
+
+        {
+            // a bulk transfer needs about one ACK per two data segments
+            TCPConfig cfg;
+            cfg.delack_timeout = 40;
+            cfg.recv_capacity = 1000000;
+            uint32_t isn = rd();
+            const size_t n_segments = 200;
+            const size_t seg_size = 1000;
+            TCPReceiver receiver{cfg};
+
+            TCPSegment syn;
+            syn.header().syn = true;
+            syn.header().seqno = WrappingInt32{isn};
+            receiver.segment_received(syn);
+            receiver.ack_sent();
+
+            for (size_t i = 0; i < n_segments; i++) {
+                TCPSegment seg;
+                seg.header().seqno = WrappingInt32{isn} + 1 + i * seg_size;
+                seg.payload() = string(seg_size, 'x');
+                receiver.segment_received(seg);
+                if (receiver.ack_due()) {
+                    receiver.ack_sent();
+                }
+            }
+
+            const auto &stats = receiver.ack_stats();
+            if (stats.segments != n_segments + 1) {
+                throw runtime_error("expected " + to_string(n_segments + 1) + " segments, got " +
+                                    to_string(stats.segments));
+            }
+            const size_t max_acks = 1 + TCPConfig::QUICKACK_DFLT + (n_segments - TCPConfig::QUICKACK_DFLT) / 2 + 1;
+            if (stats.acks_sent > max_acks) {
+                throw runtime_error("delayed ACKs sent " + to_string(stats.acks_sent) + " ACKs for " +
+                                    to_string(n_segments) + " segments");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include "receiver_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // a CE mark is echoed on every ACK until the sender's CWR arrives
+            TCPConfig cfg;
+            cfg.ecn = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_ece().with_cwr().with_seqno(isn));
+            test.execute(SendAckIfDue{});
+            test.execute(ExpectEce{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ce());
+            test.execute(ExpectEce{true});
+            test.execute(ExpectAckDue{true});
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh"));
+            test.execute(ExpectEce{true});
+            test.execute(SegmentArrives{}.with_seqno(isn + 9).with_data("ijkl").with_cwr());
+            test.execute(ExpectEce{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 13).with_data("mnop").with_cwr().with_ce());
+            test.execute(ExpectEce{true});
+            test.execute(ExpectCeMarks{2});
+        }
+
+        {
+            // a peer that didn't agree to ECN gets no echo
+            TCPConfig cfg;
+            cfg.ecn = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ce());
+            test.execute(ExpectEce{false});
+        }
+
+        {
+            // nor does one that answered our SYN with an ECN-setup SYN (ECE and CWR) instead of a SYN-ACK
+            TCPConfig cfg;
+            cfg.ecn = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_ack(rd()).with_ece().with_cwr().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ce());
+            test.execute(ExpectEce{false});
+        }
+
+        {
+            // an ECN-setup SYN-ACK carries ECE alone
+            TCPConfig cfg;
+            cfg.ecn = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_ack(rd()).with_ece().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ce());
+            test.execute(ExpectEce{true});
+        }
+
+        {
+            // without ECN configured, marks are ignored
+            TCPConfig cfg;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_ece().with_cwr().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ce());
+            test.execute(ExpectEce{false});
+        }
+
+        {
+            // DCTCP: ECE follows the latest mark, and every change is acknowledged at once
+            TCPConfig cfg;
+            cfg.ecn = true;
+            cfg.dctcp = true;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 0;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_ece().with_cwr().with_seqno(isn));
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(string(1000, 'x')));
+            test.execute(ExpectAckDue{false});
+            test.execute(ExpectEce{false});
+            test.execute(ExpectCeTransitionAck{nullopt});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1001).with_data("abcd").with_ce());
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectEce{true});
+            test.execute(ExpectCeTransitionAck{TCPReceiver::EcnAck{WrappingInt32{isn + 1001}, false}});
+            test.execute(SendAckIfDue{});
+            test.execute(ExpectCeTransitionAck{nullopt});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1005).with_data("efgh").with_ce());
+            test.execute(ExpectAckDue{false});
+            test.execute(ExpectEce{true});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1009).with_data("ijkl").with_cwr());
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectEce{false});
+            test.execute(ExpectCeTransitionAck{TCPReceiver::EcnAck{WrappingInt32{isn + 1009}, true}});
+            test.execute(ExpectCeMarks{2});
+        }
+
+        {
+            // DCTCP: with every segment acknowledged at once, a CE change owes no extra ACK
+            TCPConfig cfg;
+            cfg.ecn = true;
+            cfg.dctcp = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_ece().with_cwr().with_seqno(isn));
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(SendAckIfDue{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_ce());
+            test.execute(ExpectEce{true});
+            test.execute(ExpectCeTransitionAck{nullopt});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
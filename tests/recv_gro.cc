@@ -0,0 +1,169 @@
+#include "buffer.hh"
+#include "receiver_harness.hh"
+#include "stream_reassembler.hh"
+#include "tcp_gro.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static TCPSegment data_segment(const WrappingInt32 seqno, const string &data) {
+    TCPSegment seg;
+    seg.header().seqno = seqno;
+    seg.header().ack = true;
+    seg.header().win = 1000;
+    seg.payload() = string(data);
+    return seg;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // consecutive segments merge; a gap, a PSH and a short segment end a run
+            const WrappingInt32 isn{static_cast<uint32_t>(rd())};
+            vector<TCPSegment> batch;
+            batch.push_back(data_segment(isn + 1, "abcd"));
+            batch.push_back(data_segment(isn + 5, "efgh"));
+            batch.push_back(data_segment(isn + 9, "ijkl"));
+            batch.back().header().psh = true;
+            batch.push_back(data_segment(isn + 13, "mnop"));
+            batch.push_back(data_segment(isn + 17, "qr"));
+            batch.push_back(data_segment(isn + 19, "st"));
+            batch.push_back(data_segment(isn + 25, "yz"));
+
+            TCPSegmentCoalescer gro;
+            const auto &runs = gro.coalesce(batch);
+            if (runs.size() != 4) {
+                throw runtime_error("expected 4 runs, got " + to_string(runs.size()));
+            }
+            if (runs[0].segments != 3 || runs[0].payload.concatenate() != "abcdefghijkl" || not runs[0].header.psh ||
+                runs[0].header.seqno != isn + 1) {
+                throw runtime_error("first run should hold three segments and end with PSH");
+            }
+            if (runs[1].segments != 2 || runs[1].payload.concatenate() != "mnopqr" || runs[1].segment_size != 4) {
+                throw runtime_error("second run should end with the short segment");
+            }
+            if (runs[2].segments != 1 || runs[3].segments != 1) {
+                throw runtime_error("segments after a short one, or out of order, should not merge");
+            }
+            if (gro.stats().segments != batch.size() || gro.stats().runs != runs.size()) {
+                throw runtime_error("unexpected coalescing statistics");
+            }
+        }
+
+        {
+            // segments with different ACK fields or timestamps stay separate
+            const WrappingInt32 isn{static_cast<uint32_t>(rd())};
+            vector<TCPSegment> batch;
+            batch.push_back(data_segment(isn + 1, "abcd"));
+            batch.push_back(data_segment(isn + 5, "efgh"));
+            batch.back().header().ackno = WrappingInt32{1};
+            batch.push_back(data_segment(isn + 9, "ijkl"));
+            batch.back().header().ackno = WrappingInt32{1};
+            batch.back().header().options.ts = TCPOptions::Timestamps{7, 0};
+
+            TCPSegmentCoalescer gro;
+            if (gro.coalesce(batch).size() != 3) {
+                throw runtime_error("segments with differing headers should not merge");
+            }
+        }
+
+        {
+            // the receiver ends up in the same state whether segments arrive one by one or coalesced
+            const WrappingInt32 isn{static_cast<uint32_t>(rd())};
+            TCPConfig cfg;
+            cfg.recv_capacity = 100000;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 0;
+
+            TCPSegment syn;
+            syn.header().syn = true;
+            syn.header().seqno = isn;
+
+            string expected;
+            vector<TCPSegment> batch;
+            size_t offset = 1;
+            for (size_t i = 0; i < 40; i++) {
+                const string data(1000, static_cast<char>('a' + i % 26));
+                // leave a hole at segment 20, to be filled at the end
+                if (i != 20) {
+                    batch.push_back(data_segment(isn + offset, data));
+                }
+                expected += data;
+                offset += data.size();
+            }
+            batch.push_back(data_segment(isn + 1 + 20 * 1000, string(1000, static_cast<char>('a' + 20))));
+            batch.back().header().fin = true;
+
+            TCPReceiver one_by_one{cfg};
+            one_by_one.segment_received(syn);
+            for (const auto &seg : batch) {
+                one_by_one.segment_received(seg);
+            }
+
+            TCPReceiver coalesced{cfg};
+            coalesced.segment_received(syn);
+            TCPSegmentCoalescer gro;
+            const auto &runs = gro.coalesce(batch);
+            for (const auto &run : runs) {
+                coalesced.segment_received(run);
+            }
+
+            if (runs.size() >= batch.size() / 2) {
+                throw runtime_error("expected the batch to coalesce into a few runs, got " + to_string(runs.size()));
+            }
+            if (coalesced.ackno() != one_by_one.ackno() || coalesced.unassembled_bytes() != 0 ||
+                coalesced.stream_out().buffer_size() != expected.size()) {
+                throw runtime_error("coalesced delivery left the receiver in a different state");
+            }
+            if (coalesced.stream_out().read(expected.size()) != expected) {
+                throw runtime_error("coalesced delivery reassembled the wrong bytes");
+            }
+            if (coalesced.ack_stats().segments != one_by_one.ack_stats().segments || not coalesced.ack_due()) {
+                throw runtime_error("a coalesced run should count (and be acknowledged) as its segments");
+            }
+        }
+
+        {
+            // a run is reassembled as one substring: held as one range, and clipped to the window as a whole
+            StreamReassembler pieces{64}, whole{64};
+            for (unsigned i = 0; i < 2000; i++) {
+                BufferList run;
+                string data;
+                for (size_t n = rd() % 5; n > 0; n--) {
+                    const string piece(rd() % 20, static_cast<char>('a' + rd() % 26));
+                    run.append(BufferList{string(piece)});
+                    data += piece;
+                }
+                const size_t index = max<size_t>(pieces.stream_out().bytes_written() + rd() % 40, 20) - 20;
+                const bool eof = rd() % 500 == 0;
+                pieces.push_buffers(run, index, eof);
+                whole.push_substring(data, index, eof);
+                const size_t len = rd() % 40;
+                if (pieces.unassembled_bytes() != whole.unassembled_bytes() ||
+                    pieces.stream_out().input_ended() != whole.stream_out().input_ended() ||
+                    pieces.stream_out().read(len) != whole.stream_out().read(len)) {
+                    throw runtime_error("a run in pieces was reassembled differently from the same bytes in one");
+                }
+                if (pieces.stream_out().input_ended()) {
+                    break;
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "receiver_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // timestamps are echoed, and an old duplicate is dropped even though its seqno is in the window
+            TCPConfig cfg;
+            cfg.timestamps = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(
+                SegmentArrives{}.with_syn().with_seqno(isn).with_ts(1000).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectTsRecent{1000});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ts(1010));
+            test.execute(ExpectTsRecent{1010});
+            test.execute(ExpectAckno{WrappingInt32{isn + 5}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_ts(1005));
+            test.execute(ExpectAckno{WrappingInt32{isn + 5}});
+            test.execute(ExpectTsRecent{1010});
+            test.execute(ExpectTotalAssembledBytes{4});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_ts(1020));
+            test.execute(ExpectAckno{WrappingInt32{isn + 9}});
+            test.execute(ExpectTsRecent{1020});
+            test.execute(ExpectBytes{"abcdefgh"});
+        }
+
+        {
+            // TS.Recent only advances for segments at the left edge of the window
+            TCPConfig cfg;
+            cfg.timestamps = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_ts(50));
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_ts(70));
+            test.execute(ExpectTsRecent{50});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ts(60));
+            test.execute(ExpectTsRecent{60});
+            test.execute(ExpectAckno{WrappingInt32{isn + 9}});
+        }
+
+        {
+            // TSval comparison wraps around
+            TCPConfig cfg;
+            cfg.timestamps = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_ts(UINT32_MAX - 1));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("ab").with_ts(3));
+            test.execute(ExpectTsRecent{3});
+            test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("cd").with_ts(UINT32_MAX));
+            test.execute(ExpectAckno{WrappingInt32{isn + 3}});
+        }
+
+        {
+            // once negotiated, segments without timestamps are dropped
+            TCPConfig cfg;
+            cfg.timestamps = true;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_ts(7));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(ExpectAckno{WrappingInt32{isn + 1}});
+            test.execute(ExpectTotalAssembledBytes{0});
+        }
+
+        {
+            // no timestamps unless both sides offer them
+            TCPConfig cfg;
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_ts(1000));
+            test.execute(ExpectTsRecent{nullopt});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_ts(10));
+            test.execute(ExpectAckno{WrappingInt32{isn + 5}});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
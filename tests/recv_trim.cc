@@ -0,0 +1,73 @@
+#include "buffer.hh"
+#include "receiver_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            Buffer buf{string("abcdefgh")};
+            Buffer copy = buf;
+            buf.remove_prefix(2);
+            buf.remove_suffix(3);
+            if (buf.str() != "cde" || copy.str() != "abcdefgh") {
+                throw runtime_error("Buffer::remove_suffix should trim only its own view");
+            }
+            buf.remove_suffix(3);
+            if (buf.size() != 0) {
+                throw runtime_error("Buffer should be empty after trimming everything");
+            }
+
+            BufferList list{string("abc")};
+            list.append(BufferList{string("defg")});
+            list.remove_suffix(5);
+            if (list.concatenate() != "ab" || list.buffers().size() != 1) {
+                throw runtime_error("BufferList::remove_suffix should drop and trim buffers from the back");
+            }
+        }
+
+        {
+            // a segment straddling both edges of the window keeps only the bytes inside it
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{8};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("cdefghijkl").with_fin());
+            test.execute(ExpectAckno{WrappingInt32{isn + 9}});
+            test.execute(ExpectUnassembledBytes{0});
+            test.execute(ExpectInputNotEnded{});
+            test.execute(ExpectBytes{"abcdefgh"});
+            test.execute(SegmentArrives{}.with_seqno(isn + 9).with_data("ijkl").with_fin());
+            test.execute(ExpectAckno{WrappingInt32{isn + 14}});
+            test.execute(ExpectBytes{"ijkl"});
+            test.execute(ExpectEof{});
+        }
+
+        {
+            // data beyond the window is dropped, even when it is out of order
+            uint32_t isn = rd();
+            TCPReceiverTestHarness test{4};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("cdef"));
+            test.execute(ExpectUnassembledBytes{2});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("ab"));
+            test.execute(ExpectAckno{WrappingInt32{isn + 5}});
+            test.execute(ExpectBytes{"abcd"});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
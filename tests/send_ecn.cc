@@ -0,0 +1,207 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+TCPHeader syn_ack(const bool ece, const bool cwr) {
+    TCPHeader hdr;
+    hdr.syn = true;
+    hdr.ack = true;
+    hdr.ece = ece;
+    hdr.cwr = cwr;
+    return hdr;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPHeader hdr;
+            hdr.syn = true;
+            hdr.ece = true;
+            hdr.cwr = true;
+            const string wire = hdr.serialize();
+            if (static_cast<uint8_t>(wire[13]) != 0b1100'0010) {
+                throw runtime_error("ECE and CWR should serialize to the top two bits of the flags byte");
+            }
+            TCPHeader parsed;
+            NetParser p{string(wire)};
+            if (const auto res = parsed.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("header failed to parse: " + as_string(res));
+            }
+            if (not parsed.ece || not parsed.cwr || not parsed.syn || parsed.ack || not(parsed == hdr)) {
+                throw runtime_error("ECE and CWR did not survive a round trip");
+            }
+        }
+
+        {
+            // an active opener's SYN offers ECN with ECE and CWR; the peer's SYN-ACK accepts with ECE
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.ecn = true;
+
+            TCPSenderTestHarness test{"ECN-setup SYN", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_ece(true).with_cwr(true).with_seqno(isn));
+            test.execute(PeerSyn{syn_ack(true, false)});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_ece(false).with_cwr(false).with_data("abc"));
+            test.execute(ExpectCwnd{nullopt});
+        }
+
+        {
+            // without ECN configured, the SYN offers nothing and ECE is ignored
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"No ECN", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_ece(false).with_cwr(false).with_seqno(isn));
+            test.execute(PeerSyn{syn_ack(true, false)});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes{string(100, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(100));
+            test.execute(AckReceived{WrappingInt32{isn + 101}}.with_win(1000).with_ece());
+            test.execute(ExpectCwnd{nullopt});
+        }
+
+        {
+            // a SYN-ACK that echoes both flags (a non-compliant peer) does not enable ECN
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.ecn = true;
+
+            TCPSenderTestHarness test{"Broken ECN-setup SYN-ACK", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(PeerSyn{syn_ack(true, true)});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes{string(100, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(100));
+            test.execute(AckReceived{WrappingInt32{isn + 101}}.with_win(1000).with_ece());
+            test.execute(ExpectCwnd{nullopt});
+        }
+
+        {
+            // a passive opener answers an ECN-setup SYN with ECE alone, and a plain SYN with neither flag
+            for (const bool offered : {true, false}) {
+                TCPConfig cfg;
+                cfg.ecn = true;
+                TCPSender sender{cfg};
+                TCPHeader peer;
+                peer.syn = true;
+                peer.ece = offered;
+                peer.cwr = offered;
+                sender.negotiate(peer);
+                sender.fill_window();
+                const TCPHeader &ours = sender.segments_out().front().header();
+                if (not ours.syn || ours.ece != offered || ours.cwr || sender.ecn_enabled() != offered) {
+                    throw runtime_error("wrong ECN flags on the SYN-ACK: " + ours.summary());
+                }
+            }
+        }
+
+        {
+            // ECE halves the window once per round trip, and the next new data carries CWR
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.ecn = true;
+            const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"ECE reduces the window once per RTT", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(PeerSyn{syn_ack(true, false)});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10000, 'x')});
+            for (size_t sent = 0; sent < 10000; sent += mss) {
+                test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(min(mss, 10000 - sent)));
+            }
+            test.execute(ExpectBytesInFlight{10000});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 1000}}.with_win(60000).with_ece());
+            test.execute(ExpectCwnd{5000});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2000}}.with_win(60000).with_ece());
+            test.execute(ExpectCwnd{5000});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 10000}}.with_win(60000));
+            test.execute(ExpectCwnd{5000});
+
+            // only a window's worth goes out, and the first segment says the window was reduced
+            test.execute(WriteBytes{string(10000, 'y')});
+            test.execute(ExpectSegment{}.with_cwr(true).with_payload_size(mss));
+            test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(mss));
+            test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(mss));
+            test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(5000 - 3 * mss));
+            test.execute(ExpectNoSegment{});
+
+            // a mark on data sent after the reduction reduces the window again, but not below two segments
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 15000}}.with_win(60000).with_ece());
+            test.execute(ExpectCwnd{2 * mss});
+            test.execute(ExpectSegment{}.with_cwr(true).with_payload_size(mss));
+            test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(mss));
+            test.execute(ExpectNoSegment{});
+
+            // once the reduced window is acknowledged, it grows by one MSS per window
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 15000 + 2 * mss}}.with_win(60000));
+            test.execute(ExpectCwnd{3 * mss});
+            test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(mss));
+            test.execute(ExpectSegment{}.with_cwr(false).with_payload_size(10000 - 5000 - 3 * mss));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            // DCTCP cuts the window in proportion to the fraction of marked bytes
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.ecn = true;
+            cfg.dctcp = true;
+            const double g = 1.0 / 16;
+
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.negotiate(syn_ack(true, false));
+            sender.ack_received(isn + 1, 60000);
+            double alpha = 1 - g;  // a window (the SYN) without marks
+
+            sender.stream_in().write(string(4000, 'x'));
+            sender.fill_window();
+            sender.ack_received(isn + 1 + 4000, 60000);
+            alpha *= 1 - g;
+
+            sender.stream_in().write(string(8000, 'x'));
+            sender.fill_window();
+            sender.ack_received(isn + 1 + 5000, 60000, {}, true);
+            alpha = (1 - g) * alpha + g;  // every byte acknowledged in this window was marked
+
+            if (fabs(sender.dctcp_alpha() - alpha) > 1e-9) {
+                throw runtime_error("DCTCP alpha is " + to_string(sender.dctcp_alpha()) + ", expected " +
+                                    to_string(alpha));
+            }
+            const uint64_t expected = 8000 * (1 - alpha / 2);
+            if (sender.cwnd() != expected || expected <= 4000) {
+                throw runtime_error("DCTCP reduced the window to " + to_string(sender.cwnd().value_or(0)) +
+                                    ", expected " + to_string(expected));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -305,53 +305,106 @@ int main() {
             cfg.fixed_isn = isn;
             cfg.rt_timeout = rto;
 
-            TCPSenderTestHarness test{
-                "When filling window, treat a '0' window size as equal to '1' but don't back off RTO", cfg};
+            TCPSenderTestHarness test{"A '0' window is probed one byte at a time, on a persist timer that backs off",
+                                      cfg};
             test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
             test.execute(WriteBytes("abc"));
             test.execute(ExpectNoSegment{});
             test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
             test.execute(ExpectState{TCPSenderStateSummary::SYN_ACKED});
-            test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1).with_no_flags());
+            test.execute(ExpectNoSegment{});
             test.execute(Close{});
             test.execute(ExpectNoSegment{});
 
-            for (unsigned int i = 0; i < 5; i++) {
-                test.execute(Tick{rto - 1});
+            // the same probe is resent at doubling intervals, and these are not retransmissions
+            size_t timeout = rto;
+            for (unsigned int i = 0; i < 2 * TCPConfig::MAX_RETX_ATTEMPTS; i++) {
+                test.execute(Tick{timeout - 1});
                 test.execute(ExpectNoSegment{});
-                test.execute(Tick{1});
+                test.execute(Tick{1}.with_max_retx_exceeded(false));
                 test.execute(ExpectSegment{}.with_payload_size(1).with_data("a").with_seqno(isn + 1).with_no_flags());
+                timeout = min<size_t>(2 * timeout, TCPConfig::MAX_RTO);
             }
+            test.execute(ExpectPersistProbes{2 * TCPConfig::MAX_RETX_ATTEMPTS});
 
+            // a probe that is accepted resets the backoff, though the window stays shut
             test.execute(AckReceived{isn + 2}.with_win(0));
+            test.execute(ExpectPersistProbes{0});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(1).with_data("b").with_seqno(isn + 2).with_no_flags());
+            test.execute(Tick{2 * rto});
             test.execute(ExpectSegment{}.with_payload_size(1).with_data("b").with_seqno(isn + 2).with_no_flags());
-
-            for (unsigned int i = 0; i < 5; i++) {
-                test.execute(Tick{rto - 1});
-                test.execute(ExpectNoSegment{});
-                test.execute(Tick{1});
-                test.execute(ExpectSegment{}.with_payload_size(1).with_data("b").with_seqno(isn + 2).with_no_flags());
-            }
 
             test.execute(AckReceived{isn + 3}.with_win(0));
+            test.execute(Tick{rto});
             test.execute(ExpectSegment{}.with_payload_size(1).with_data("c").with_seqno(isn + 3).with_no_flags());
 
-            for (unsigned int i = 0; i < 5; i++) {
-                test.execute(Tick{rto - 1});
-                test.execute(ExpectNoSegment{});
-                test.execute(Tick{1});
-                test.execute(ExpectSegment{}.with_payload_size(1).with_data("c").with_seqno(isn + 3).with_no_flags());
-            }
-
+            // the FIN is a probe too
             test.execute(AckReceived{isn + 4}.with_win(0));
+            test.execute(Tick{rto});
             test.execute(ExpectSegment{}.with_payload_size(0).with_data("").with_seqno(isn + 4).with_fin(true));
+            test.execute(Tick{2 * rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(0).with_data("").with_seqno(isn + 4).with_fin(true));
+            test.execute(AckReceived{isn + 5}.with_win(0));
+            test.execute(ExpectState{TCPSenderStateSummary::FIN_ACKED});
+            test.execute(ExpectNextTimeout{nullopt});
+            test.execute(Tick{10 * rto});
+            test.execute(ExpectNoSegment{});
+        }
 
-            for (unsigned int i = 0; i < 5; i++) {
-                test.execute(Tick{rto - 1});
-                test.execute(ExpectNoSegment{});
-                test.execute(Tick{1});
-                test.execute(ExpectSegment{}.with_payload_size(0).with_data("").with_seqno(isn + 4).with_fin(true));
-            }
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = rto;
+
+            TCPSenderTestHarness test{"A '0' window with nothing to send runs no timer until data is written", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(ExpectNextTimeout{nullopt});
+            test.execute(Tick{10 * rto});
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectNextTimeout{nullopt});
+
+            test.execute(WriteBytes("a"));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectNextTimeout{rto});
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(0));
+            test.execute(ExpectNextTimeout{nullopt});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = rto;
+
+            TCPSenderTestHarness test{"A window update reopens a zero window at once", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(WriteBytes("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10));
+            test.execute(ExpectSegment{}.with_data("bc").with_seqno(isn + 2));
+            test.execute(ExpectNoSegment{});
+
+            // the outstanding probe is now left to the retransmission timer
+            test.execute(Tick{rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(ExpectPersistProbes{0});
         }
 
         {
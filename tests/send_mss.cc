@@ -0,0 +1,164 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 4000;
+
+            TCPSender sender{cfg};
+            sender.fill_window();
+            const TCPSegment seg = sender.segments_out().front();
+            if (seg.header().options.mss != cfg.mss) {
+                throw runtime_error("SYN did not carry the configured MSS option");
+            }
+            if (seg.header().serialize().size() != TCPHeader::LENGTH + 4) {
+                throw runtime_error("SYN with MSS option should have a 24-byte header");
+            }
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 9000;
+            const size_t peer_mss = 8000;
+            const string data(20000, 'x');
+
+            TCPSenderTestHarness test{"Large MSS on both ends gives large segments", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            TCPOptions peer;
+            peer.mss = peer_mss;
+            test.execute(PeerSynOptions{peer});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(data)});
+            test.execute(ExpectSegment{}.with_payload_size(peer_mss).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(peer_mss).with_seqno(isn + 1 + peer_mss));
+            test.execute(
+                ExpectSegment{}.with_payload_size(data.size() - 2 * peer_mss).with_seqno(isn + 1 + 2 * peer_mss));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            const size_t peer_mss = 536;
+
+            TCPSenderTestHarness test{"Peer's smaller MSS limits payload", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            TCPOptions peer;
+            peer.mss = peer_mss;
+            test.execute(PeerSynOptions{peer});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes{string(1000, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(peer_mss).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000 - peer_mss).with_seqno(isn + 1 + peer_mss));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 40;
+
+            TCPSenderTestHarness test{"A tiny peer MSS is raised to the minimum, but never above ours", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            TCPOptions peer;
+            peer.mss = 1;
+            test.execute(PeerSynOptions{peer});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes{string(100, 'z')});
+            test.execute(ExpectSegment{}.with_payload_size(cfg.mss).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(cfg.mss).with_seqno(isn + 1 + cfg.mss));
+            test.execute(ExpectSegment{}.with_payload_size(100 - 2 * cfg.mss).with_seqno(isn + 1 + 2 * cfg.mss));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Peer without MSS option leaves our MSS in effect", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(PeerSynOptions{TCPOptions{}});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(2000));
+            test.execute(WriteBytes{string(2000, 'z')});
+            test.execute(ExpectSegment{}.with_payload_size(TCPConfig::MAX_PAYLOAD_SIZE).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}
+                             .with_payload_size(2000 - TCPConfig::MAX_PAYLOAD_SIZE)
+                             .with_seqno(isn + 1 + TCPConfig::MAX_PAYLOAD_SIZE));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPOptions opts;
+            opts.mss = 1460;
+            opts.sack_permitted = true;
+            opts.ts = TCPOptions::Timestamps{0x01020304, 0};
+            opts.wscale = 7;
+
+            TCPHeader hdr;
+            hdr.syn = true;
+            hdr.options = opts;
+            const string wire = hdr.serialize();
+            if (wire.size() != TCPHeader::LENGTH + 20 || (static_cast<uint8_t>(wire[12]) >> 4) != 10) {
+                throw runtime_error("SYN options should serialize to 20 bytes with doff == 10");
+            }
+
+            TCPHeader parsed;
+            NetParser p{string(wire)};
+            if (const auto res = parsed.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("options failed to parse: " + as_string(res));
+            }
+            if (parsed.options.mss != opts.mss || parsed.options.wscale != opts.wscale ||
+                not parsed.options.sack_permitted || not parsed.options.ts.has_value() ||
+                parsed.options.ts.value().val != opts.ts.value().val || parsed.doff != 10) {
+                throw runtime_error("options did not survive a round trip: " + parsed.options.to_string());
+            }
+            if (parsed.serialize() != wire) {
+                throw runtime_error("re-serialized options differ from the original");
+            }
+        }
+
+        {
+            // options that end the packet are decoded after the parser has dropped them (and, here, its bytes)
+            TCPHeader hdr;
+            hdr.ack = true;
+            hdr.options.ts = TCPOptions::Timestamps{static_cast<uint32_t>(rd()), static_cast<uint32_t>(rd())};
+            hdr.options.sack_permitted = true;
+
+            TCPHeader parsed;
+            NetParser p{hdr.serialize()};
+            if (const auto res = parsed.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("header-only segment failed to parse: " + as_string(res));
+            }
+            if (not parsed.options.ts.has_value() || parsed.options.ts.value().val != hdr.options.ts.value().val ||
+                parsed.options.ts.value().ecr != hdr.options.ts.value().ecr || not parsed.options.sack_permitted) {
+                throw runtime_error("options at the end of a packet decoded wrongly: " + parsed.options.to_string());
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include "tcp_config.hh"
+#include "tcp_receiver.hh"
+#include "tcp_sender.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! Average payload size of the data segments needed to move `total` bytes to a reader
+//! that consumes `read_size` bytes per round of the event loop
+static double average_segment_size(TCPConfig cfg, const size_t total, const size_t read_size) {
+    TCPSender sender{cfg};
+    TCPReceiver receiver{cfg};
+
+    size_t segments = 0;
+    size_t payload_bytes = 0;
+    size_t bytes_read = 0;
+    uint64_t last_edge = 0;
+
+    const auto send_ack = [&] {
+        receiver.ack_sent();
+        last_edge = receiver.stream_out().bytes_written() + receiver.window_size();
+        sender.ack_received(receiver.ackno().value(), receiver.window_size());
+    };
+
+    for (size_t round = 0; bytes_read < total; round++) {
+        if (round > 1000000) {
+            throw runtime_error("transfer made no progress");
+        }
+
+        // the writer keeps the sender's stream full
+        const size_t to_write = min(sender.stream_in().remaining_capacity(),
+                                    total - min(total, sender.stream_in().bytes_written()));
+        sender.stream_in().write(string(to_write, 'x'));
+        if (sender.stream_in().bytes_written() == total) {
+            sender.stream_in().end_input();
+        }
+        sender.fill_window();
+
+        bool delivered = false;
+        while (not sender.segments_out().empty()) {
+            const TCPSegment seg = sender.segments_out().front();
+            sender.segments_out().pop();
+            if (seg.payload().size() > 0) {
+                segments++;
+                payload_bytes += seg.payload().size();
+            }
+            receiver.segment_received(seg);
+            delivered = true;
+        }
+        if (delivered) {
+            send_ack();
+        }
+
+        // the slow reader
+        bytes_read += receiver.stream_out().read(min(read_size, receiver.stream_out().buffer_size())).size();
+
+        // a window update is sent whenever the advertised right edge would move
+        if (receiver.stream_out().bytes_written() + receiver.window_size() > last_edge) {
+            send_ack();
+        }
+
+        sender.tick(1);
+    }
+
+    return static_cast<double>(payload_bytes) / segments;
+}
+
+int main() {
+    try {
+        TCPConfig cfg;
+        cfg.recv_capacity = 8000;
+        cfg.mss = 1000;
+        const size_t total = 200000;
+        const size_t read_size = 10;
+
+        const double plain = average_segment_size(cfg, total, read_size);
+
+        TCPConfig rcv_only = cfg;
+        rcv_only.sws_avoidance = true;
+        const double receiver_side = average_segment_size(rcv_only, total, read_size);
+
+        TCPConfig snd_only = cfg;
+        snd_only.nagle = true;
+        const double sender_side = average_segment_size(snd_only, total, read_size);
+
+        TCPConfig both = cfg;
+        both.sws_avoidance = true;
+        both.nagle = true;
+        const double both_sides = average_segment_size(both, total, read_size);
+
+        if (plain > 2 * read_size) {
+            throw runtime_error("expected the slow reader to cause tiny segments without SWS avoidance, got " +
+                                to_string(plain));
+        }
+        if (receiver_side < cfg.mss / 2 || sender_side < cfg.mss / 2 || both_sides < cfg.mss / 2) {
+            throw runtime_error("SWS avoidance should keep segments at least half an MSS on average, got " +
+                                to_string(receiver_side) + " (receiver), " + to_string(sender_side) +
+                                " (sender), " + to_string(both_sides) + " (both)");
+        }
+
+        // the override switch turns Nagle off again
+        {
+            TCPConfig nagle = cfg;
+            nagle.nagle = true;
+            nagle.fixed_isn = WrappingInt32{0};
+            TCPSender sender{nagle};
+            sender.fill_window();
+            sender.segments_out().pop();
+            sender.ack_received(WrappingInt32{1}, 4000);
+            sender.stream_in().write("a");
+            sender.fill_window();
+            sender.stream_in().write("b");
+            sender.fill_window();
+            if (sender.segments_out().size() != 1) {
+                throw runtime_error("Nagle should hold back a small segment while data is in flight");
+            }
+            sender.set_nodelay(true);
+            sender.fill_window();
+            if (sender.segments_out().size() != 2) {
+                throw runtime_error("TCP_NODELAY-style override should release the small segment");
+            }
+        }
+
+        // a small window with nothing in flight: the data held back goes out when the override timer expires
+        {
+            TCPConfig nagle = cfg;
+            nagle.nagle = true;
+            nagle.fixed_isn = WrappingInt32{0};
+            TCPSender sender{nagle};
+            sender.fill_window();
+            sender.segments_out().pop();
+            sender.ack_received(WrappingInt32{1}, 4000);
+            sender.ack_received(WrappingInt32{1}, 100);
+            sender.stream_in().write(string(500, 'x'));
+            sender.fill_window();
+            if (not sender.segments_out().empty() || sender.next_timeout() != TCPConfig::SWS_OVERRIDE) {
+                throw runtime_error("a small segment should be held back, with the override timer armed");
+            }
+            sender.tick(TCPConfig::SWS_OVERRIDE - 1);
+            if (not sender.segments_out().empty()) {
+                throw runtime_error("held-back data was sent before the override timer expired");
+            }
+            sender.tick(1);
+            if (sender.segments_out().size() != 1 || sender.segments_out().front().payload().size() != 100) {
+                throw runtime_error("the override timer should send what fits in the window");
+            }
+            if (sender.next_timeout() != nagle.rt_timeout) {
+                throw runtime_error("once data is in flight, the retransmission timer should take over");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
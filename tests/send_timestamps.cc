@@ -0,0 +1,90 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.timestamps = true;
+
+            TCPSenderTestHarness test{"Every ACK of new data gives an RTT sample", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_ts(true).with_seqno(isn));
+            TCPOptions peer;
+            peer.ts = TCPOptions::Timestamps{1, 0};
+            test.execute(PeerSynOptions{peer});
+            const uint32_t now = timestamp_ms();
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_ts(2, now));
+            test.execute(ExpectRttSamples{1});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc").with_ts(true));
+            test.execute(WriteBytes{"def"});
+            test.execute(ExpectSegment{}.with_data("def").with_ts(true));
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_ts(3, now));
+            test.execute(ExpectRttSamples{2});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_ts(4, now));
+            test.execute(ExpectRttSamples{2});
+            test.execute(AckReceived{WrappingInt32{isn + 7}}.with_ts(5, now));
+            test.execute(ExpectRttSamples{3});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.timestamps = true;
+            const size_t rto = cfg.rt_timeout;
+
+            TCPSenderTestHarness test{"A retransmission can be timed too", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_ts(true).with_seqno(isn));
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_syn(true).with_ts(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_ts(1, timestamp_ms()));
+            test.execute(ExpectRttSamples{1});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.timestamps = true;
+
+            TCPSenderTestHarness test{"Timestamps are dropped if the peer doesn't offer them", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_ts(true).with_seqno(isn));
+            test.execute(PeerSynOptions{TCPOptions{}});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_ts(2, timestamp_ms()));
+            test.execute(ExpectRttSamples{0});
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc").with_ts(false));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Timestamps are off by default", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_ts(false).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_ts(2, timestamp_ms()));
+            test.execute(ExpectRttSamples{0});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -99,6 +99,72 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+struct ExpectRttSamples : public SenderExpectation {
+    size_t _n_samples;
+
+    ExpectRttSamples(size_t n_samples) : _n_samples(n_samples) {}
+    std::string description() const { return std::to_string(_n_samples) + " RTT samples"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.rtt_samples() != _n_samples) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported " << sender.rtt_samples() << " RTT samples, but there were expected to be "
+               << _n_samples;
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectPersistProbes : public SenderExpectation {
+    unsigned int _probes;
+
+    ExpectPersistProbes(const unsigned int probes) : _probes(probes) {}
+    std::string description() const { return std::to_string(_probes) + " unanswered zero-window probes"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.persist_probes() != _probes) {
+            throw SenderExpectationViolation("The TCPSender reported " + std::to_string(sender.persist_probes()) +
+                                             " unanswered zero-window probes, but there were expected to be " +
+                                             std::to_string(_probes));
+        }
+    }
+};
+
+struct ExpectNextTimeout : public SenderExpectation {
+    std::optional<size_t> _timeout;
+
+    ExpectNextTimeout(const std::optional<size_t> timeout) : _timeout(timeout) {}
+    static std::string describe(const std::optional<size_t> timeout) {
+        return timeout.has_value() ? "next timeout in " + std::to_string(timeout.value()) + " ms" : "no timer running";
+    }
+    std::string description() const { return describe(_timeout); }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.next_timeout() != _timeout) {
+            throw SenderExpectationViolation("The TCPSender reported " + describe(sender.next_timeout()) +
+                                             ", but it was expected to report " + description());
+        }
+    }
+};
+
+struct ExpectCwnd : public SenderExpectation {
+    std::optional<uint64_t> _cwnd;
+
+    ExpectCwnd(const std::optional<uint64_t> cwnd) : _cwnd(cwnd) {}
+    std::string description() const {
+        return _cwnd.has_value() ? "cwnd " + std::to_string(_cwnd.value()) : "no cwnd";
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.cwnd() != _cwnd) {
+            const std::string reported =
+                sender.cwnd().has_value() ? "cwnd " + std::to_string(sender.cwnd().value()) : "no cwnd";
+            throw SenderExpectationViolation("The TCPSender reported " + reported + ", but it was expected to report " +
+                                             description());
+        }
+    }
+};
+
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
     std::string description() const { return "no (more) segments"; }
@@ -191,11 +257,16 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    TCPOptions _options{};
+    bool _ece{false};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        if (_ece) {
+            ss << " with ECE";
+        }
         return ss.str();
     }
 
@@ -204,12 +275,40 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    AckReceived &with_ts(uint32_t val, uint32_t ecr) {
+        _options.ts = TCPOptions::Timestamps{val, ecr};
+        return *this;
+    }
+
+    AckReceived &with_ece() {
+        _ece = true;
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
-        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW), _options, _ece);
         sender.fill_window();
     }
 };
 
+struct PeerSynOptions : public SenderAction {
+    TCPOptions _options;
+
+    PeerSynOptions(const TCPOptions &options) : _options(options) {}
+    std::string description() const { return "peer SYN with options: " + _options.to_string(); }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const { sender.negotiate(_options); }
+};
+
+struct PeerSyn : public SenderAction {
+    TCPHeader _header;
+
+    PeerSyn(const TCPHeader &header) : _header(header) {}
+    std::string description() const { return "peer SYN " + _header.summary(); }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const { sender.negotiate(_header); }
+};
+
 struct Close : public SenderAction {
     Close() {}
     std::string description() const { return "close"; }
@@ -230,6 +329,9 @@ struct ExpectSegment : public SenderExpectation {
     std::optional<uint16_t> win{};
     std::optional<size_t> payload_size{};
     std::optional<std::string> data{};
+    std::optional<bool> ts{};
+    std::optional<bool> ece{};
+    std::optional<bool> cwr{};
 
     ExpectSegment &with_ack(bool ack_) {
         ack = ack_;
@@ -288,6 +390,21 @@ struct ExpectSegment : public SenderExpectation {
         return *this;
     }
 
+    ExpectSegment &with_ts(bool ts_) {
+        ts = ts_;
+        return *this;
+    }
+
+    ExpectSegment &with_ece(bool ece_) {
+        ece = ece_;
+        return *this;
+    }
+
+    ExpectSegment &with_cwr(bool cwr_) {
+        cwr = cwr_;
+        return *this;
+    }
+
     std::string segment_description() const {
         std::ostringstream o;
         o << "(";
@@ -303,6 +420,12 @@ struct ExpectSegment : public SenderExpectation {
         if (fin.has_value()) {
             o << (fin.value() ? "F=1," : "F=0,");
         }
+        if (ece.has_value()) {
+            o << (ece.value() ? "E=1," : "E=0,");
+        }
+        if (cwr.has_value()) {
+            o << (cwr.value() ? "W=1," : "W=0,");
+        }
         if (ackno.has_value()) {
             o << "ackno=" << ackno.value() << ",";
         }
@@ -315,6 +438,9 @@ struct ExpectSegment : public SenderExpectation {
         if (payload_size.has_value()) {
             o << "payload_size=" << payload_size.value() << ",";
         }
+        if (ts.has_value()) {
+            o << (ts.value() ? "TS," : "no TS,");
+        }
         if (data.has_value()) {
             o << "\"";
             for (unsigned int i = 0; i < std::min(size_t(16), data.value().size()); i++) {
@@ -336,7 +462,7 @@ struct ExpectSegment : public SenderExpectation {
 
     virtual std::string description() const { return "segment sent with " + segment_description(); }
 
-    void execute(TCPSender &, std::queue<TCPSegment> &segments) const {
+    void execute(TCPSender &sender, std::queue<TCPSegment> &segments) const {
         if (segments.empty()) {
             throw SegmentExpectationViolation::violated_verb("existed");
         }
@@ -354,6 +480,12 @@ struct ExpectSegment : public SenderExpectation {
         if (fin.has_value() and seg.header().fin != fin.value()) {
             throw SegmentExpectationViolation::violated_field("fin", fin.value(), seg.header().fin);
         }
+        if (ece.has_value() and seg.header().ece != ece.value()) {
+            throw SegmentExpectationViolation::violated_field("ece", ece.value(), seg.header().ece);
+        }
+        if (cwr.has_value() and seg.header().cwr != cwr.value()) {
+            throw SegmentExpectationViolation::violated_field("cwr", cwr.value(), seg.header().cwr);
+        }
         if (seqno.has_value() and seg.header().seqno != seqno.value()) {
             throw SegmentExpectationViolation::violated_field("seqno", seqno.value(), seg.header().seqno);
         }
@@ -367,7 +499,11 @@ struct ExpectSegment : public SenderExpectation {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
         }
-        if (seg.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE) {
+        if (ts.has_value() and seg.header().options.ts.has_value() != ts.value()) {
+            throw SegmentExpectationViolation::violated_field(
+                "timestamps option", ts.value(), seg.header().options.ts.has_value());
+        }
+        if (seg.payload().size() > sender.mss()) {
             throw SegmentExpectationViolation("packet has length (" + std::to_string(seg.payload().size()) +
                                               ") greater than the maximum");
         }
@@ -394,7 +530,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
@@ -0,0 +1,109 @@
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "tcp_header_view.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        for (unsigned i = 0; i < 1000; i++) {
+            TCPSegment seg;
+            TCPHeader &hdr = seg.header();
+            hdr.sport = rd();
+            hdr.dport = rd();
+            hdr.seqno = WrappingInt32{static_cast<uint32_t>(rd())};
+            hdr.ackno = WrappingInt32{static_cast<uint32_t>(rd())};
+            const uint8_t flags = rd();
+            hdr.cwr = flags & 0x80;
+            hdr.ece = flags & 0x40;
+            hdr.urg = flags & 0x20;
+            hdr.ack = flags & 0x10;
+            hdr.psh = flags & 0x08;
+            hdr.rst = flags & 0x04;
+            hdr.syn = flags & 0x02;
+            hdr.fin = flags & 0x01;
+            hdr.win = rd();
+            hdr.uptr = rd();
+            if (i % 2) {
+                hdr.options.ts = TCPOptions::Timestamps{static_cast<uint32_t>(rd()), static_cast<uint32_t>(rd())};
+            }
+            seg.payload() = string(rd() % 100, 'x');
+            const uint32_t pseudo = rd() % 0x4'0000;
+            string wire = seg.serialize(pseudo).concatenate();
+
+            // every field reads as it was written
+            TCPHeaderView view;
+            if (const auto res = view.parse(wire); res != ParseResult::NoError) {
+                throw runtime_error("view failed to parse: " + as_string(res));
+            }
+            if (view.sport() != hdr.sport || view.dport() != hdr.dport || view.seqno() != hdr.seqno ||
+                view.ackno() != hdr.ackno || view.cwr() != hdr.cwr || view.ece() != hdr.ece ||
+                view.urg() != hdr.urg || view.ack() != hdr.ack || view.psh() != hdr.psh || view.rst() != hdr.rst ||
+                view.syn() != hdr.syn || view.fin() != hdr.fin || view.win() != hdr.win ||
+                view.uptr() != hdr.uptr || view.payload() != seg.payload().str() ||
+                view.length_in_sequence_space() != seg.length_in_sequence_space()) {
+                throw runtime_error("view disagrees with the header it was serialized from: " + hdr.to_string());
+            }
+            TCPHeader decoded;
+            TCPHeader expected;
+            NetParser p{string{wire}};
+            expected.parse(p);
+            if (view.decode(decoded) != ParseResult::NoError || not(decoded == expected) ||
+                view.doff() != expected.doff || decoded.options.ts.has_value() != hdr.options.ts.has_value()) {
+                throw runtime_error("view decoded the wrong header");
+            }
+
+            // in-place edits keep the checksum correct
+            MutableTCPHeaderView edit;
+            edit.parse(wire);
+            const WrappingInt32 seqno{static_cast<uint32_t>(rd())};
+            const WrappingInt32 ackno{static_cast<uint32_t>(rd())};
+            const uint16_t win = rd();
+            edit.set_seqno(seqno);
+            edit.set_ackno(ackno);
+            edit.set_win(win);
+            TCPSegment parsed;
+            if (const auto res = parsed.parse(string{wire}, pseudo); res != ParseResult::NoError) {
+                throw runtime_error("edited segment failed to parse: " + as_string(res));
+            }
+            if (parsed.header().seqno != seqno || parsed.header().ackno != ackno || parsed.header().win != win ||
+                parsed.header().sport != hdr.sport || parsed.payload().str() != seg.payload().str()) {
+                throw runtime_error("edit did not change just the fields it set");
+            }
+        }
+
+        {
+            // truncated segments and bad data offsets are caught as TCPHeader::parse() catches them
+            TCPHeader hdr;
+            hdr.options.mss = 1460;
+            const string wire = hdr.serialize();
+            TCPHeaderView view;
+            if (view.parse(wire.substr(0, 16)) != ParseResult::PacketTooShort ||
+                view.parse(wire.substr(0, 22)) != ParseResult::PacketTooShort) {
+                throw runtime_error("view accepted a truncated header");
+            }
+            string bad = wire;
+            bad[12] = 0x40;
+            if (view.parse(bad) != ParseResult::HeaderTooShort) {
+                throw runtime_error("view accepted a data offset below 5");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
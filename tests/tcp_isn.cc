@@ -0,0 +1,71 @@
+#include "address.hh"
+#include "tcp_isn.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            // reference vectors from the SipHash paper: key 00 01 .. 0f, message 00 01 .. (len - 1)
+            const array<uint64_t, 2> key{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+            array<uint8_t, 15> msg{};
+            for (size_t i = 0; i < msg.size(); i++) {
+                msg[i] = i;
+            }
+            if (ISNGenerator::siphash24(key, msg.data(), 0) != 0x726fdb47dd0e0e31ULL ||
+                ISNGenerator::siphash24(key, msg.data(), 8) != 0x93f5f5799a932462ULL ||
+                ISNGenerator::siphash24(key, msg.data(), 15) != 0xa129ca6149be45e5ULL) {
+                throw runtime_error("SipHash-2-4 does not match the reference vectors");
+            }
+        }
+
+        {
+            // the same 4-tuple gets ISNs that advance with the clock (4 us per tick); others are unrelated
+            const Address local{"10.0.0.1", 40000};
+            const Address remote{"10.0.0.2", 80};
+            const WrappingInt32 first = ISNGenerator::isn(local, remote);
+            const WrappingInt32 again = ISNGenerator::isn(local, remote);
+            if (again - first < 0 || again - first > 250000) {
+                throw runtime_error("ISNs for one 4-tuple should advance with the clock");
+            }
+
+            set<uint32_t> offsets;
+            for (uint16_t port = 40000; port < 41000; port++) {
+                const WrappingInt32 a = ISNGenerator::isn(Address{"10.0.0.1", port}, remote);
+                const WrappingInt32 b = ISNGenerator::isn(local, remote);
+                // subtract the clock (nearly the same for both) to leave the hash of the 4-tuple
+                offsets.insert((a.raw_value() - b.raw_value() + 0x8000) >> 16);
+            }
+            if (offsets.size() < 900) {
+                throw runtime_error("ISNs of different 4-tuples look related");
+            }
+        }
+
+        {
+            // connections without a 4-tuple get distinct ISNs
+            set<uint32_t> isns;
+            for (size_t i = 0; i < 10000; i++) {
+                isns.insert(ISNGenerator::isn().raw_value());
+            }
+            if (isns.size() < 9990) {
+                throw runtime_error("repeated ISNs: " + to_string(10000 - isns.size()));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -185,9 +185,25 @@ int main(int argc, char **argv) {
                 continue;
             }
 
-            // parse succeeded. Create a new segment and rebuild the header by unparsing.
+            // parse succeeded. First, check that the header (including options) unparses to the original bytes.
             cout << dec;
 
+            if (tcp_seg.header().options.unknown_options() == 0) {
+                const string hdr_out = tcp_seg.header().serialize();
+                const auto hdr_orig = reinterpret_cast<const char *>(tcp_seg_data);
+                if (hdr_out.size() != 4 * tcp_seg.header().doff ||
+                    not equal(hdr_out.begin(), hdr_out.begin() + 16, hdr_orig) ||
+                    not equal(hdr_out.begin() + 18, hdr_out.end(), hdr_orig + 18)) {
+                    cout << "ERROR: options did not survive a round trip: " << tcp_seg.header().options.to_string()
+                         << "\n";
+                    hexdump(tcp_seg_data, 4 * tcp_seg.header().doff);
+                    ok = false;
+                    continue;
+                }
+            }
+
+            // Create a new segment and rebuild the header by unparsing.
+
             TCPSegment tcp_seg_copy;
             tcp_seg_copy.payload() = tcp_seg.payload();
 
@@ -198,6 +214,7 @@ int main(int argc, char **argv) {
                 tcp_hdr_copy = tcp_hdr_orig;
                 // fix up segment to remove IPv4 and TCP header extensions
                 tcp_hdr_copy.doff = 5;
+                tcp_hdr_copy.options = {};
             }  // tcp_hdr_{orig,copy} go out of scope
 
             if (!compare_tcp_headers_nolen(tcp_seg.header(), tcp_seg_copy.header())) {
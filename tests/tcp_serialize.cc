@@ -0,0 +1,92 @@
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        for (unsigned i = 0; i < 1000; i++) {
+            TCPSegment seg;
+            TCPHeader &hdr = seg.header();
+            hdr.sport = rd();
+            hdr.dport = rd();
+            hdr.seqno = WrappingInt32{static_cast<uint32_t>(rd())};
+            hdr.ackno = WrappingInt32{static_cast<uint32_t>(rd())};
+            const uint8_t flags = rd();
+            hdr.cwr = flags & 0x80;
+            hdr.ece = flags & 0x40;
+            hdr.urg = flags & 0x20;
+            hdr.ack = flags & 0x10;
+            hdr.psh = flags & 0x08;
+            hdr.rst = flags & 0x04;
+            hdr.syn = flags & 0x02;
+            hdr.fin = flags & 0x01;
+            hdr.win = rd();
+            hdr.uptr = rd();
+            if (i % 2) {
+                hdr.options.ts = TCPOptions::Timestamps{static_cast<uint32_t>(rd()), static_cast<uint32_t>(rd())};
+            }
+            if (i % 3 == 0) {
+                hdr.options.mss = rd();
+                hdr.options.wscale = rd() % 15;
+                hdr.options.sack_permitted = true;
+            }
+            seg.payload() = string(rd() % 100, 'x');
+            const uint32_t pseudo = rd() % 0x4'0000;
+            const string wire = seg.serialize(pseudo).concatenate();
+            const size_t wire_header_length = wire.size() - seg.payload().size();
+
+            // the header written into caller-provided storage is the one serialize() produces
+            array<uint8_t, TCPHeader::MAX_LENGTH> storage;
+            const size_t header_length = seg.serialize_header_into(storage.data(), storage.size(), pseudo);
+            if (header_length != wire_header_length ||
+                wire.compare(0, header_length, reinterpret_cast<const char *>(storage.data()), header_length) != 0) {
+                throw runtime_error("serialize_header_into() disagrees with serialize()");
+            }
+
+            // as is the header alone, which fits exactly in storage of its own length
+            const string header = hdr.serialize();
+            if (hdr.serialize_into(storage.data(), header.size()) != header.size() ||
+                header.compare(0, header.size(), reinterpret_cast<const char *>(storage.data()), header.size()) != 0) {
+                throw runtime_error("TCPHeader::serialize_into() disagrees with TCPHeader::serialize()");
+            }
+        }
+
+        {
+            // storage too small for the header (options included) is refused, not overrun
+            TCPHeader hdr;
+            hdr.options.mss = 1460;
+            array<uint8_t, TCPHeader::LENGTH + 3> small;
+            try {
+                hdr.serialize_into(small.data(), small.size());
+                throw logic_error("serialize_into() overran its storage");
+            } catch (const runtime_error &) {
+            }
+
+            TCPSegment seg;
+            seg.header() = hdr;
+            try {
+                seg.serialize_header_into(small.data(), small.size());
+                throw logic_error("serialize_header_into() overran its storage");
+            } catch (const runtime_error &) {
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include "tcp_receiver.hh"
+#include "tcp_sender.hh"
+#include "timer_wheel.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            // every timer fires exactly at its deadline, however far off, and cancelled ones never do
+            const uint64_t start = rd() % 100000;
+            TimerWheel wheel{start};
+            const size_t n = 20000;
+
+            vector<uint64_t> fired_at(n, 0);
+            vector<unique_ptr<TimerWheel::Timer>> timers;
+            vector<uint64_t> deadline(n);
+            vector<bool> cancelled(n, false);
+            for (size_t i = 0; i < n; i++) {
+                timers.push_back(make_unique<TimerWheel::Timer>([&, i] { fired_at[i] = wheel.now(); }));
+                // a mix of near, far and beyond-the-wheel deadlines
+                const uint64_t range = uint64_t{1} << (rd() % 27);
+                deadline[i] = start + 1 + uniform_int_distribution<uint64_t>{0, range}(rd);
+                wheel.arm(*timers[i], deadline[i]);
+            }
+            for (size_t i = 0; i < n; i += 7) {
+                timers[i]->cancel();
+                cancelled[i] = true;
+            }
+            // re-arming moves the deadline
+            for (size_t i = 3; i < n; i += 11) {
+                if (not cancelled[i]) {
+                    deadline[i] = start + 1 + rd() % 5000;
+                    wheel.arm(*timers[i], deadline[i]);
+                }
+            }
+
+            uint64_t now = start;
+            const uint64_t end = start + (uint64_t{1} << 27) + 10;
+            while (wheel.size() > 0) {
+                now += 1 + rd() % (now < start + 20000 ? 50 : 5000000);
+                wheel.advance(min(now, end));
+                if (wheel.size() > 0 && now >= end) {
+                    throw runtime_error("timers left armed past their deadlines");
+                }
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                if (cancelled[i] && fired_at[i] != 0) {
+                    throw runtime_error("a cancelled timer fired");
+                }
+                if (not cancelled[i] && fired_at[i] != deadline[i]) {
+                    throw runtime_error("timer with deadline " + to_string(deadline[i]) + " fired at " +
+                                        to_string(fired_at[i]));
+                }
+            }
+        }
+
+        {
+            // a callback may re-arm its own timer; a deadline in the past fires on the next advance
+            TimerWheel wheel;
+            size_t fired = 0;
+            TimerWheel::Timer periodic{[&] {
+                fired++;
+                wheel.arm_after(periodic, 100);
+            }};
+            wheel.arm(periodic, 0);
+            if (wheel.advance(1) != 1 || fired != 1 || periodic.expires() != 101) {
+                throw runtime_error("past deadline did not fire on the next advance");
+            }
+            wheel.advance(1000);
+            if (fired != 10 || not periodic.armed()) {
+                throw runtime_error("periodic timer fired " + to_string(fired) + " times");
+            }
+        }
+
+        {
+            // a TCPSender driven by a TimerWheel retransmits as if it were ticked every millisecond
+            TCPConfig cfg;
+            cfg.rt_timeout = 300;
+            TCPSender ticked{cfg};
+            TCPSender timed{cfg};
+            TimerWheel wheel;
+            uint64_t last_tick = 0;
+            TimerWheel::Timer rto{[&] {
+                timed.tick(wheel.now() - last_tick);
+                last_tick = wheel.now();
+                if (timed.next_timeout().has_value()) {
+                    wheel.arm_after(rto, timed.next_timeout().value());
+                }
+            }};
+
+            ticked.fill_window();
+            timed.fill_window();
+            wheel.arm_after(rto, timed.next_timeout().value());
+            for (uint64_t ms = 1; ms <= 5000; ms++) {
+                ticked.tick(1);
+                wheel.advance(ms);
+                if (ticked.segments_out().size() != timed.segments_out().size() ||
+                    ticked.consecutive_retransmissions() != timed.consecutive_retransmissions()) {
+                    throw runtime_error("wheel-driven sender diverged at " + to_string(ms) + " ms");
+                }
+            }
+            if (timed.consecutive_retransmissions() != 4) {
+                throw runtime_error("expected 4 retransmissions, saw " +
+                                    to_string(timed.consecutive_retransmissions()));
+            }
+        }
+
+        {
+            // the receiver's deadline is the delayed-ACK timer
+            TCPConfig cfg;
+            cfg.delack_timeout = 40;
+            cfg.quickack = 0;
+            TCPReceiver receiver{cfg};
+            TCPSegment syn;
+            syn.header().syn = true;
+            receiver.segment_received(syn);
+            receiver.ack_sent();
+            if (receiver.next_timeout().has_value()) {
+                throw runtime_error("idle receiver should have no deadline");
+            }
+            TCPSegment data;
+            data.header().seqno = syn.header().seqno + 1;
+            data.payload() = string(100, 'x');
+            receiver.segment_received(data);
+            receiver.tick(15);
+            if (receiver.next_timeout() != 25) {
+                throw runtime_error("delayed ACK should be due in 25 ms");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}